@@ -0,0 +1,223 @@
+// =============================== ORDERINGS ================================ //
+// Project:         epidesim
+// Name:            orderings.cpp
+// Description:     Benchmark of graph sweeps over reordered agents
+// Creator:         Vincent Reverdy
+// Contributor(s):  Vincent Reverdy [2020-]
+// License:         BSD 3-Clause License
+// ========================================================================== //
+
+
+
+// ============================== PREAMBLE ================================== //
+// C++ standard library
+#include <cmath>
+#include <tuple>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <algorithm>
+// Project sources
+#include "graphs.hpp"
+#include "parallel.hpp"
+#include "orderings.hpp"
+#include "transmission.hpp"
+// Third-party libraries
+// Miscellaneous
+using namespace epidesim;
+// ========================================================================== //
+
+
+
+// ============================ BENCHMARK GRAPH ============================= //
+// Layers of the benchmarked graph
+struct household {};
+struct neighborhood {};
+using graph_type = contact_graph<type_pack<household, neighborhood>>;
+using transmission_type = frontier_transmission<graph_type>;
+
+// A synthetic population: households of one to five agents are laid out on a
+// jittered grid, each agent has contacts in nearby households, and both the
+// agents and the households are numbered at random, as when they are read
+// from unsorted inputs
+struct population {
+    std::vector<std::uint32_t> households;
+    std::vector<double> x;
+    std::vector<double> y;
+    graph_type graph;
+};
+
+// Builds a population of about the provided number of agents
+population make_population(std::size_t size) {
+    using edge_type = std::tuple<std::uint32_t, std::uint32_t>;
+    std::mt19937 engine(1);
+    std::uniform_real_distribution<double> jitter(0, 1);
+    std::vector<std::size_t> first = {0};
+    while (first.back() < size) {
+        first.push_back(first.back() + 1 + engine() % 5);
+    }
+    const std::size_t count = first.size() - 1;
+    const std::size_t agents = first.back();
+    const std::size_t side = static_cast<std::size_t>(
+        std::ceil(std::sqrt(double(count)))
+    );
+    std::vector<std::uint32_t> labels(count);
+    std::vector<std::uint32_t> ids(agents);
+    std::iota(labels.begin(), labels.end(), 0);
+    std::iota(ids.begin(), ids.end(), 0);
+    std::shuffle(labels.begin(), labels.end(), engine);
+    std::shuffle(ids.begin(), ids.end(), engine);
+    population result;
+    result.households.resize(agents);
+    result.x.resize(agents);
+    result.y.resize(agents);
+    std::vector<edge_type> households;
+    std::vector<edge_type> neighborhoods;
+    for (std::size_t h = 0; h < count; ++h) {
+        const double x = double(h % side) + jitter(engine);
+        const double y = double(h / side) + jitter(engine);
+        for (std::size_t i = first[h]; i < first[h + 1]; ++i) {
+            result.households[ids[i]] = labels[h];
+            result.x[ids[i]] = x;
+            result.y[ids[i]] = y;
+            for (std::size_t j = first[h]; j < i; ++j) {
+                households.emplace_back(ids[j], ids[i]);
+            }
+            for (std::size_t k = 0; k < 4; ++k) {
+                const std::ptrdiff_t dx = std::ptrdiff_t(engine() % 5) - 2;
+                const std::ptrdiff_t dy = std::ptrdiff_t(engine() % 5) - 2;
+                const std::size_t other = std::min(
+                    std::size_t(std::max(
+                        std::ptrdiff_t(h) + dx + dy * std::ptrdiff_t(side),
+                        std::ptrdiff_t(0)
+                    )),
+                    count - 1
+                );
+                const std::size_t members = first[other + 1] - first[other];
+                const std::size_t j = first[other] + engine() % members;
+                if (j != i) {
+                    neighborhoods.emplace_back(ids[i], ids[j]);
+                }
+            }
+        }
+    }
+    result.graph.resize(agents);
+    result.graph.assign<household>(households, true);
+    result.graph.assign<neighborhood>(neighborhoods, true);
+    return result;
+}
+// ========================================================================== //
+
+
+
+// ================================ SWEEPS ================================== //
+// The best times in milliseconds of a pushing and of a pulling step
+struct sweep_times {
+    double push;
+    double pull;
+};
+
+// Times transmission steps over a graph from a frontier of a tenth of the
+// agents, renumbered with the provided order
+sweep_times sweep(
+    thread_pool& pool,
+    const graph_type& base,
+    const ordering& order,
+    std::size_t repetitions
+) {
+    using clock = std::chrono::steady_clock;
+    const ordering rank = invert_ordering(order);
+    graph_type graph = base;
+    graph.permute(order, rank);
+    const std::size_t size = graph.vertices();
+    std::vector<std::uint8_t> states(size, 0);
+    agent_frontier infectious(size);
+    for (std::size_t i = 0; i < size; i += 10) {
+        states[rank[i]] = 1;
+        infectious.mark(rank[i]);
+    }
+    infectious.collect();
+    agent_frontier infected(size);
+    const counter_based_rng<> rng(7);
+    transmission_type pushing(graph, 0.1, transmission_type::all_layers, 1);
+    transmission_type pulling(graph, 0.1, transmission_type::all_layers, 0);
+    sweep_times result = {INFINITY, INFINITY};
+    for (std::size_t repetition = 0; repetition < repetitions; ++repetition) {
+        for (transmission_type* transmission: {&pushing, &pulling}) {
+            infected.clear();
+            const clock::time_point start = clock::now();
+            transmission->step(pool, states, 0, infectious, rng, infected);
+            const std::chrono::duration<double, std::milli> elapsed
+            = clock::now() - start;
+            double& best = transmission == &pushing
+            ? result.push
+            : result.pull;
+            best = std::min(best, elapsed.count());
+        }
+    }
+    return result;
+}
+
+// Reports the times of the steps over a graph renumbered with an order
+void measure(
+    const char* name,
+    thread_pool& pool,
+    const graph_type& graph,
+    const ordering& order,
+    std::size_t repetitions
+) {
+    const sweep_times times = sweep(pool, graph, order, repetitions);
+    std::printf(
+        "%-10s push %9.3f ms pull %9.3f ms\n",
+        name, times.push, times.pull
+    );
+}
+// ========================================================================== //
+
+
+
+// ================================== MAIN ================================== //
+// Compares transmission steps before and after reordering the agents, for
+// the number of agents and of repetitions given as arguments
+int main(int argc, char* argv[]) {
+    const std::size_t size = argc > 1 ? std::stoull(argv[1]) : 2000000;
+    const std::size_t repetitions = argc > 2 ? std::stoull(argv[2]) : 10;
+    const population agents = make_population(size);
+    const graph_type& graph = agents.graph;
+    thread_pool pool;
+    ordering identity(graph.vertices());
+    std::iota(identity.begin(), identity.end(), 0);
+    std::printf(
+        "%zu agents, %zu edges, %zu threads\n",
+        graph.vertices(), graph.edges(), pool.size()
+    );
+    measure("original", pool, graph, identity, repetitions);
+    measure(
+        "household",
+        pool,
+        graph,
+        household_major_ordering(agents.households),
+        repetitions
+    );
+    measure(
+        "rcm",
+        pool,
+        graph,
+        reverse_cuthill_mckee_ordering(graph),
+        repetitions
+    );
+    measure(
+        "hilbert",
+        pool,
+        graph,
+        hilbert_ordering(agents.x, agents.y),
+        repetitions
+    );
+    return 0;
+}
+// ========================================================================== //
@@ -0,0 +1,96 @@
+// ================================== PACK ================================== //
+// Project:         epidesim
+// Name:            pack.cpp
+// Description:     Compile-time benchmark of the algorithms on type packs
+// Creator:         Vincent Reverdy
+// Contributor(s):  Vincent Reverdy [2020-]
+// License:         BSD 3-Clause License
+// ========================================================================== //
+
+
+
+// ============================== PREAMBLE ================================== //
+// C++ standard library
+#include <cstddef>
+#include <utility>
+#include <type_traits>
+// Project sources
+#include "pack.hpp"
+#include "wrappers.hpp"
+// Third-party libraries
+// Miscellaneous
+#ifndef EPIDESIM_BENCHMARK_SIZE
+#define EPIDESIM_BENCHMARK_SIZE 256
+#endif
+using namespace epidesim;
+// ========================================================================== //
+
+
+
+// ============================== BENCHMARK PACKS =========================== //
+// A distinct attribute type per index, as in the schemas of the models
+template <std::size_t Index>
+struct attribute {
+    double value;
+};
+
+// Makes a pack of attributes with each attribute repeated: declaration
+template <class Indices>
+struct attributes;
+
+// Makes a pack of attributes with each attribute repeated: indexed
+// specialization, half of the indices naming already listed attributes
+template <std::size_t... Indices>
+struct attributes<std::index_sequence<Indices...>> {
+    static constexpr std::size_t distinct = sizeof...(Indices) / 2 + 1;
+    using type = type_pack<attribute<Indices % distinct>...>;
+};
+
+// Counts the types of a type pack without instantiating it: declaration
+template <class Pack>
+struct count;
+
+// Counts the types of a type pack without instantiating it: type pack
+// specialization
+template <class... Types>
+struct count<type_pack<Types...>>
+: std::integral_constant<std::size_t, sizeof...(Types)> {};
+
+// Checks whether an attribute has an even index: declaration
+template <class T>
+struct is_even;
+
+// Checks whether an attribute has an even index: attribute specialization
+template <std::size_t Index>
+struct is_even<attribute<Index>>: std::bool_constant<Index % 2 == 0> {};
+
+// Splits a pack into single type packs and concatenates them back: declaration
+template <class Pack>
+struct split;
+
+// Splits a pack into single type packs and concatenates them back: type pack
+// specialization
+template <class... Types>
+struct split<type_pack<Types...>> {
+    using type = pack_concat_t<type_pack<Types>...>;
+};
+// ========================================================================== //
+
+
+
+// ================================== MAIN ================================== //
+// Runs the algorithms once on a pack of the size of the benchmark, whose
+// compilation time measures their instantiation cost
+int main() {
+    constexpr std::size_t size = EPIDESIM_BENCHMARK_SIZE;
+    using pack = typename attributes<std::make_index_sequence<size>>::type;
+    using unique = pack_unique_t<pack>;
+    using even = pack_filter_t<unique, type_trait<is_even>>;
+    using pointers = pack_transform_t<even, type_trait<std::add_pointer>>;
+    static_assert(count<typename split<pack>::type>::value == size);
+    static_assert(count<unique>::value == size / 2 + 1);
+    static_assert(count<pointers>::value == size / 4 + 1);
+    static_assert(pack_index_of_v<unique, attribute<size / 2>> == size / 2);
+    return 0;
+}
+// ========================================================================== //
@@ -0,0 +1,203 @@
+// ================================= STORES ================================= //
+// Project:         epidesim
+// Name:            stores.cpp
+// Description:     Benchmark of the layouts of the agent stores
+// Creator:         Vincent Reverdy
+// Contributor(s):  Vincent Reverdy [2020-]
+// License:         BSD 3-Clause License
+// ========================================================================== //
+
+
+
+// ============================== PREAMBLE ================================== //
+// C++ standard library
+#include <cmath>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+// Project sources
+#include "stores.hpp"
+// Third-party libraries
+// Miscellaneous
+using namespace epidesim;
+// ========================================================================== //
+
+
+
+// ============================ BENCHMARK SCHEMA ============================ //
+// Attributes read by the benchmarked kernel
+struct age {
+    std::uint8_t value;
+};
+struct state {
+    std::uint8_t value;
+};
+struct contacts {
+    float value;
+};
+struct susceptibility {
+    float value;
+};
+struct infectiousness {
+    float value;
+};
+
+// Attribute written by the benchmarked kernel
+struct risk {
+    float value;
+};
+
+// Attributes not used by the benchmarked kernel
+struct household {
+    std::uint32_t value;
+};
+struct workplace {
+    std::uint32_t value;
+};
+
+// The schema of the benchmarked agents
+using schema = type_pack<
+    age,
+    state,
+    contacts,
+    susceptibility,
+    infectiousness,
+    risk,
+    household,
+    workplace
+>;
+// ========================================================================== //
+
+
+
+// ================================ KERNELS ================================= //
+// The risk of an agent, from several of its attributes
+inline float agent_risk(
+    std::uint8_t age,
+    std::uint8_t state,
+    float contacts,
+    float susceptibility,
+    float infectiousness
+) noexcept {
+    const float factor = age >= 65 ? 2.f : 1.f;
+    const float exposure = contacts * susceptibility * factor;
+    return state == 0 ? exposure * (1.f - infectiousness) : 0.f;
+}
+
+// Fills a store with agents of deterministic attributes
+template <class Store>
+void fill(Store& store, std::size_t size) {
+    store.reserve(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        const std::uint32_t hash = static_cast<std::uint32_t>(i) * 2654435761u;
+        store.push_back(
+            age{static_cast<std::uint8_t>(hash % 90)},
+            state{static_cast<std::uint8_t>(hash % 3)},
+            contacts{static_cast<float>(hash % 20)},
+            susceptibility{static_cast<float>(hash % 100) / 100.f},
+            infectiousness{static_cast<float>(hash % 7) / 7.f},
+            risk{0.f},
+            household{hash % 1000},
+            workplace{hash % 5000}
+        );
+    }
+}
+
+// Runs the kernel over a structure of arrays
+template <class Container>
+void sweep(soa_store<schema, Container>& store) {
+    const auto& ages = store.template column<age>();
+    const auto& states = store.template column<state>();
+    const auto& contact = store.template column<contacts>();
+    const auto& susceptible = store.template column<susceptibility>();
+    const auto& infectious = store.template column<infectiousness>();
+    auto& risks = store.template column<risk>();
+    const std::size_t size = store.size();
+    for (std::size_t i = 0; i < size; ++i) {
+        risks[i].value = agent_risk(
+            ages[i].value,
+            states[i].value,
+            contact[i].value,
+            susceptible[i].value,
+            infectious[i].value
+        );
+    }
+}
+
+// Runs the kernel over the tiles of an array of structures of arrays
+template <class Width, class Container>
+void sweep(aosoa_store<schema, Width, Container>& store) {
+    constexpr std::size_t width = Width::value;
+    const std::size_t tiles = store.tiles();
+    for (std::size_t t = 0; t < tiles; ++t) {
+        auto& tile = store.tile(t);
+        const auto& ages = tile.template lanes<age>();
+        const auto& states = tile.template lanes<state>();
+        const auto& contact = tile.template lanes<contacts>();
+        const auto& susceptible = tile.template lanes<susceptibility>();
+        const auto& infectious = tile.template lanes<infectiousness>();
+        auto& risks = tile.template lanes<risk>();
+        for (std::size_t lane = 0; lane < width; ++lane) {
+            risks[lane].value = agent_risk(
+                ages[lane].value,
+                states[lane].value,
+                contact[lane].value,
+                susceptible[lane].value,
+                infectious[lane].value
+            );
+        }
+    }
+}
+
+// Returns the sum of the risks of a store, so that sweeps are not elided
+template <class Store>
+double total(const Store& store) {
+    double result = 0;
+    for (std::size_t i = 0; i < store.size(); ++i) {
+        result += store.template value<risk>(i).value;
+    }
+    return result;
+}
+
+// Reports the best time per agent of the sweeps of a layout
+template <class Store>
+void measure(const char* name, std::size_t size, std::size_t repetitions) {
+    using clock = std::chrono::steady_clock;
+    Store store;
+    fill(store, size);
+    double best = INFINITY;
+    for (std::size_t repetition = 0; repetition < repetitions; ++repetition) {
+        const clock::time_point start = clock::now();
+        sweep(store);
+        const std::chrono::duration<double, std::nano> elapsed
+        = clock::now() - start;
+        best = std::min(best, elapsed.count() / static_cast<double>(size));
+    }
+    std::printf(
+        "%-8s %12zu agents %8.3f ns/agent (total %.6g)\n",
+        name, size, best, total(store)
+    );
+}
+// ========================================================================== //
+
+
+
+// ================================== MAIN ================================== //
+// Compares the layouts on a kernel reading several attributes of each agent,
+// for the number of agents and of repetitions given as arguments
+int main(int argc, char* argv[]) {
+    const std::size_t size = argc > 1 ? std::stoull(argv[1]) : 10000000;
+    const std::size_t repetitions = argc > 2 ? std::stoull(argv[2]) : 10;
+    measure<soa_store<schema>>("soa", size, repetitions);
+    measure<aosoa_store<schema, size_constant<8>>>("aosoa8", size, repetitions);
+    measure<aosoa_store<schema, size_constant<16>>>(
+        "aosoa16",
+        size,
+        repetitions
+    );
+    return 0;
+}
+// ========================================================================== //
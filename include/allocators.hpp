@@ -0,0 +1,609 @@
+// =============================== ALLOCATORS =============================== //
+// Project:         epidesim
+// Name:            allocators.hpp
+// Description:     Memory resources and allocators for per-tick scratch data
+// Creator:         Vincent Reverdy
+// Contributor(s):  Vincent Reverdy [2020-]
+// License:         BSD 3-Clause License
+// ========================================================================== //
+#ifndef _ALLOCATORS_HPP_INCLUDED
+#define _ALLOCATORS_HPP_INCLUDED
+// ========================================================================== //
+
+
+
+// ============================== PREAMBLE ================================== //
+// C++ standard library
+#include <new>
+#include <array>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+// Project sources
+#include "traits.hpp"
+// Third-party libraries
+// Miscellaneous
+#if defined(__linux__)
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+namespace epidesim {
+// ========================================================================== //
+
+
+
+// =============================== HEAP MEMORY ============================== //
+// An upstream source of arena blocks drawing them from the global heap
+struct heap_memory {
+    using size_type = std::size_t;
+    static constexpr size_type alignment = alignof(std::max_align_t);
+    static void* allocate(size_type bytes) {
+        return ::operator new(bytes, std::align_val_t(alignment));
+    }
+    static void deallocate(void* pointer, size_type) noexcept {
+        ::operator delete(pointer, std::align_val_t(alignment));
+    }
+};
+// ========================================================================== //
+
+
+
+// ============================ MONOTONIC ARENA ============================= //
+// A memory resource handing out memory by bumping a pointer through blocks
+// of growing sizes drawn from an upstream source: deallocation is a no-op,
+// resetting the arena rewinds it in constant time while keeping its blocks
+// for the next use, and retiring it starts the next allocation in a new block
+template <class Upstream = heap_memory>
+class basic_monotonic_arena
+{
+    // Types
+    public:
+    using upstream_type = Upstream;
+    using size_type = std::size_t;
+
+    // Constants
+    public:
+    static constexpr size_type default_block_size = 65536;
+    static constexpr size_type alignment = alignof(std::max_align_t);
+
+    // Lifecycle
+    public:
+    basic_monotonic_arena() = default;
+    explicit basic_monotonic_arena(size_type block_size)
+    : _block_size(std::max(block_size, alignment)) {
+    }
+    basic_monotonic_arena(const basic_monotonic_arena&) = delete;
+    basic_monotonic_arena& operator=(const basic_monotonic_arena&) = delete;
+    ~basic_monotonic_arena() {
+        release();
+    }
+
+    // Allocation
+    public:
+    void* allocate(size_type bytes, size_type align = alignment) {
+        while (_current < _blocks.size()) {
+            block& current = _blocks[_current];
+            const size_type address = reinterpret_cast<size_type>(
+                current.data + _offset
+            );
+            const size_type padding = (align - address % align) % align;
+            if (padding + bytes <= current.size - _offset) {
+                _offset += padding + bytes;
+                _used += padding + bytes;
+                return current.data + _offset - bytes;
+            }
+            ++_current;
+            _offset = 0;
+        }
+        const size_type previous = _blocks.empty() ? 0 : _blocks.back().size;
+        const size_type size = std::max({
+            _block_size,
+            2 * previous,
+            bytes + std::max(align, alignment)
+        });
+        _blocks.push_back(block{static_cast<std::byte*>(
+            upstream_type::allocate(size)
+        ), size});
+        _capacity += size;
+        _current = _blocks.size() - 1;
+        return allocate(bytes, align);
+    }
+    void deallocate(void*, size_type, size_type = alignment) noexcept {
+    }
+
+    // Management
+    public:
+    void reset() noexcept {
+        _current = 0;
+        _offset = 0;
+        _used = 0;
+    }
+    void release() noexcept {
+        for (block& current: _blocks) {
+            upstream_type::deallocate(current.data, current.size);
+        }
+        _blocks.clear();
+        _capacity = 0;
+        reset();
+    }
+    void retire() noexcept {
+        _current = _blocks.size();
+        _offset = 0;
+    }
+    size_type used() const noexcept {
+        return _used;
+    }
+    size_type capacity() const noexcept {
+        return _capacity;
+    }
+    static basic_monotonic_arena& default_resource() noexcept {
+        thread_local basic_monotonic_arena resource;
+        return resource;
+    }
+
+    // Implementation details
+    private:
+    struct block {
+        std::byte* data;
+        size_type size;
+    };
+    std::vector<block> _blocks;
+    size_type _block_size = default_block_size;
+    size_type _current = 0;
+    size_type _offset = 0;
+    size_type _used = 0;
+    size_type _capacity = 0;
+};
+
+// An arena drawing its blocks from the global heap
+using monotonic_arena = basic_monotonic_arena<>;
+// ========================================================================== //
+
+
+
+// ============================== POOL RESOURCE ============================= //
+// A memory resource recycling fixed-size blocks: requests are rounded up to a
+// power of two size class with its own free list, blocks are carved from an
+// arena, and requests larger than the largest class go to the global heap
+class pool_resource
+{
+    // Types
+    public:
+    using size_type = std::size_t;
+
+    // Constants
+    public:
+    static constexpr size_type classes = 8;
+    static constexpr size_type min_block_size = sizeof(void*);
+    static constexpr size_type max_block_size = min_block_size << (classes - 1);
+    static constexpr size_type alignment = monotonic_arena::alignment;
+
+    // Lifecycle
+    public:
+    pool_resource() = default;
+    explicit pool_resource(size_type slab_size): _slabs(slab_size) {
+    }
+    pool_resource(const pool_resource&) = delete;
+    pool_resource& operator=(const pool_resource&) = delete;
+
+    // Allocation
+    public:
+    void* allocate(size_type bytes, size_type align = alignment) {
+        if (bytes > max_block_size || align > alignment) {
+            return ::operator new(bytes, std::align_val_t(align));
+        }
+        const size_type index = _index(bytes);
+        if (_free[index]) {
+            return std::exchange(_free[index], _free[index]->next);
+        }
+        const size_type size = min_block_size << index;
+        return _slabs.allocate(size, std::min(size, alignment));
+    }
+    void deallocate(
+        void* pointer,
+        size_type bytes,
+        size_type align = alignment
+    ) noexcept {
+        if (bytes > max_block_size || align > alignment) {
+            ::operator delete(pointer, std::align_val_t(align));
+        } else {
+            const size_type index = _index(bytes);
+            _free[index] = ::new (pointer) link{_free[index]};
+        }
+    }
+
+    // Management
+    public:
+    void reset() noexcept {
+        _free.fill(nullptr);
+        _slabs.reset();
+    }
+    void release() noexcept {
+        _free.fill(nullptr);
+        _slabs.release();
+    }
+    size_type capacity() const noexcept {
+        return _slabs.capacity();
+    }
+    static pool_resource& default_resource() noexcept {
+        thread_local pool_resource resource;
+        return resource;
+    }
+
+    // Implementation details
+    private:
+    struct link {
+        link* next;
+    };
+    static size_type _index(size_type bytes) noexcept {
+        size_type index = 0;
+        for (size_type size = min_block_size; size < bytes; size *= 2) {
+            ++index;
+        }
+        return index;
+    }
+    monotonic_arena _slabs;
+    std::array<link*, classes> _free = {};
+};
+// ========================================================================== //
+
+
+
+// =========================== RESOURCE ALLOCATOR =========================== //
+// A standard allocator drawing its memory from a resource: it satisfies
+// is_allocator and rebinds along with containers through rebind_container,
+// and defaults to the resource of the calling thread when default constructed
+template <class T, class Resource>
+class resource_allocator
+{
+    // Friendship
+    template <class, class>
+    friend class resource_allocator;
+
+    // Types
+    public:
+    using value_type = T;
+    using resource_type = Resource;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    template <class U>
+    struct rebind {
+        using other = resource_allocator<U, Resource>;
+    };
+
+    // Lifecycle
+    public:
+    resource_allocator() noexcept
+    : _resource(&resource_type::default_resource()) {
+    }
+    resource_allocator(resource_type& resource) noexcept
+    : _resource(&resource) {
+    }
+    template <class U>
+    resource_allocator(const resource_allocator<U, Resource>& other) noexcept
+    : _resource(other._resource) {
+    }
+
+    // Allocation
+    public:
+    T* allocate(size_type count) {
+        return static_cast<T*>(
+            _resource->allocate(count * sizeof(T), alignof(T))
+        );
+    }
+    void deallocate(T* pointer, size_type count) noexcept {
+        _resource->deallocate(pointer, count * sizeof(T), alignof(T));
+    }
+
+    // Access
+    public:
+    resource_type* resource() const noexcept {
+        return _resource;
+    }
+
+    // Comparison
+    public:
+    template <class U>
+    friend bool operator==(
+        const resource_allocator& lhs,
+        const resource_allocator<U, Resource>& rhs
+    ) noexcept {
+        return lhs.resource() == rhs.resource();
+    }
+    template <class U>
+    friend bool operator!=(
+        const resource_allocator& lhs,
+        const resource_allocator<U, Resource>& rhs
+    ) noexcept {
+        return lhs.resource() != rhs.resource();
+    }
+
+    // Implementation details
+    private:
+    resource_type* _resource;
+};
+
+// Alias template for allocators drawing from a monotonic arena
+template <class T>
+using arena_allocator = resource_allocator<T, monotonic_arena>;
+
+// Alias template for allocators drawing from a pool resource
+template <class T>
+using pool_allocator = resource_allocator<T, pool_resource>;
+// ========================================================================== //
+
+
+
+// =============================== NUMA NODE ================================ //
+// Returns the memory node of the processor running the calling thread, or
+// zero when the platform does not expose it
+inline std::size_t numa_node() noexcept {
+#if defined(__linux__) && defined(SYS_getcpu)
+    unsigned int cpu = 0;
+    unsigned int node = 0;
+    if (::syscall(SYS_getcpu, &cpu, &node, nullptr) == 0) {
+        return node;
+    }
+#endif
+    return 0;
+}
+// ========================================================================== //
+
+
+
+// ============================== NUMA COUNTERS ============================= //
+// Counters of the memory placed on each node by first touch, along with the
+// time spent touching it, so that the placement of each socket can be
+// checked: one byte is written per page, so that the time is dominated by
+// page faults and the rate of placement is not a memory bandwidth. Counters
+// are updated atomically and shared by all the threads of the process
+class numa_counters
+{
+    // Types
+    public:
+    using size_type = std::size_t;
+
+    // Constants
+    public:
+    static constexpr size_type max_nodes = 64;
+
+    // Recording
+    public:
+    void record(size_type node, size_type bytes, double seconds) noexcept {
+        node = std::min(node, max_nodes - 1);
+        _bytes[node].fetch_add(bytes, std::memory_order_relaxed);
+        _nanoseconds[node].fetch_add(
+            static_cast<size_type>(seconds * 1e9),
+            std::memory_order_relaxed
+        );
+    }
+    void reset() noexcept {
+        for (size_type node = 0; node < max_nodes; ++node) {
+            _bytes[node].store(0, std::memory_order_relaxed);
+            _nanoseconds[node].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    // Access
+    public:
+    size_type nodes() const noexcept {
+        size_type result = 0;
+        for (size_type node = 0; node < max_nodes; ++node) {
+            result = bytes(node) > 0 ? node + 1 : result;
+        }
+        return result;
+    }
+    size_type bytes(size_type node) const noexcept {
+        return _bytes[node].load(std::memory_order_relaxed);
+    }
+    double seconds(size_type node) const noexcept {
+        return _nanoseconds[node].load(std::memory_order_relaxed) * 1e-9;
+    }
+    double placement_rate(size_type node) const noexcept {
+        const double elapsed = seconds(node);
+        return elapsed > 0 ? bytes(node) / elapsed : 0;
+    }
+    static numa_counters& global() noexcept {
+        static numa_counters counters;
+        return counters;
+    }
+
+    // Implementation details
+    private:
+    std::array<std::atomic<size_type>, max_nodes> _bytes = {};
+    std::array<std::atomic<size_type>, max_nodes> _nanoseconds = {};
+};
+// ========================================================================== //
+
+
+
+// =============================== NUMA MEMORY ============================== //
+// An upstream source of arena blocks mapping fresh pages and touching them
+// from the calling thread, so that the operating system places them on the
+// node of the thread owning the arena under a first-touch policy; pages can
+// also be mapped without being touched, to be placed later by first touch
+struct numa_memory {
+    using size_type = std::size_t;
+    static constexpr size_type alignment = alignof(std::max_align_t);
+    static size_type page_size() noexcept {
+#if defined(__linux__)
+        static const size_type size = static_cast<size_type>(
+            ::sysconf(_SC_PAGESIZE)
+        );
+        return size;
+#else
+        return 4096;
+#endif
+    }
+    static void* allocate(size_type bytes) {
+        void* pointer = map(bytes);
+        touch(pointer, bytes);
+        return pointer;
+    }
+    static void deallocate(void* pointer, size_type bytes) noexcept {
+#if defined(__linux__)
+        ::munmap(pointer, bytes);
+#else
+        static_cast<void>(bytes);
+        ::operator delete(pointer, std::align_val_t(alignment));
+#endif
+    }
+    static void* map(size_type bytes) {
+#if defined(__linux__)
+        void* pointer = ::mmap(
+            nullptr,
+            bytes,
+            PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS,
+            -1,
+            0
+        );
+        if (pointer == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+#else
+        void* pointer = ::operator new(bytes, std::align_val_t(alignment));
+#endif
+        return pointer;
+    }
+    static void touch(void* pointer, size_type bytes) noexcept {
+        using clock = std::chrono::steady_clock;
+        const clock::time_point start = clock::now();
+        volatile std::byte* data = static_cast<std::byte*>(pointer);
+        for (size_type i = 0; i < bytes; i += page_size()) {
+            data[i] = std::byte(0);
+        }
+        const std::chrono::duration<double> elapsed = clock::now() - start;
+        numa_counters::global().record(numa_node(), bytes, elapsed.count());
+    }
+};
+// ========================================================================== //
+
+
+
+// =============================== FIRST TOUCH ============================== //
+// Touches a range of untouched memory in parallel with the provided executor,
+// cutting it into one contiguous partition of pages per worker, each worker
+// touching the partition of its own index, which loops of the same size start
+// with in the thread pool: placement is best effort, since work stealing can
+// later hand pages to other workers, and the partitions of workers that took
+// no part in the loop are touched by the calling thread
+template <class Executor>
+void first_touch(Executor& executor, void* pointer, std::size_t bytes) {
+    const std::size_t page = numa_memory::page_size();
+    const std::size_t pages = (bytes + page - 1) / page;
+    const std::size_t workers = std::max(executor.size(), std::size_t(1));
+    const std::size_t partitions = std::min(workers, pages);
+    std::byte* data = static_cast<std::byte*>(pointer);
+    std::vector<std::atomic<bool>> touched(partitions);
+    const auto touch = [=, &touched](std::size_t partition) {
+        if (!touched[partition].exchange(true, std::memory_order_relaxed)) {
+            const std::size_t first = partition * pages / partitions * page;
+            const std::size_t last = std::min(
+                (partition + 1) * pages / partitions * page,
+                bytes
+            );
+            numa_memory::touch(data + first, last - first);
+        }
+    };
+    executor.parallel_for(0, partitions, 1, [&](std::size_t) {
+        const std::size_t worker = executor.worker();
+        if (worker < partitions) {
+            touch(worker);
+        }
+    });
+    for (std::size_t partition = 0; partition < partitions; ++partition) {
+        touch(partition);
+    }
+}
+
+// Maps fresh pages and places them by touching them in parallel with the
+// provided executor: the memory is released with numa_memory::deallocate
+template <class Executor>
+void* first_touch(Executor& executor, std::size_t bytes) {
+    void* pointer = numa_memory::map(bytes);
+    first_touch(executor, pointer, bytes);
+    return pointer;
+}
+// ========================================================================== //
+
+
+
+// ============================== NUMA ALLOCATOR ============================ //
+// An arena whose blocks are placed on the node of the thread growing it: the
+// default arenas are owned by the process rather than by threads, so that
+// containers allocated by a worker remain valid after the worker exits, and
+// the arena of an exited thread is handed over to the next thread asking for
+// one, its memory already handed out being never reused and its next
+// allocations starting a fresh block placed on the node of the new thread
+class numa_arena: public basic_monotonic_arena<numa_memory>
+{
+    // Lifecycle
+    public:
+    using basic_monotonic_arena::basic_monotonic_arena;
+
+    // Management
+    public:
+    static numa_arena& default_resource() noexcept {
+        thread_local const _lease lease;
+        return *lease.arena;
+    }
+
+    // Implementation details
+    private:
+    struct _registry {
+        std::mutex mutex;
+        std::deque<numa_arena> arenas;
+        std::vector<numa_arena*> available;
+    };
+    struct _lease {
+        _lease() {
+            _registry& registry = _arenas();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            if (registry.available.empty()) {
+                arena = &registry.arenas.emplace_back();
+            } else {
+                arena = registry.available.back();
+                registry.available.pop_back();
+                arena->retire();
+            }
+        }
+        _lease(const _lease&) = delete;
+        _lease& operator=(const _lease&) = delete;
+        ~_lease() {
+            _registry& registry = _arenas();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            registry.available.push_back(arena);
+        }
+        numa_arena* arena = nullptr;
+    };
+    static _registry& _arenas() noexcept {
+        // Never destroyed, so that it outlives the leases of exiting threads
+        static _registry* registry = new _registry;
+        return *registry;
+    }
+};
+
+// Alias template for allocators drawing from the numa arena of the calling
+// thread by default, so that each worker owns its partition of the storage
+template <class T>
+using numa_allocator = resource_allocator<T, numa_arena>;
+// ========================================================================== //
+
+
+
+// ========================================================================== //
+} // namespace epidesim
+#endif // _ALLOCATORS_HPP_INCLUDED
+// ========================================================================== //
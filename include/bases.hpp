@@ -1,42 +1,135 @@
-// ================================== BASE ================================== //
+// ================================== BASES ================================= //
 // Project:         epidesim
-// Name:            base.hpp
+// Name:            bases.hpp
 // Description:     Generic bases to help with the creation of common types
 // Creator:         Vincent Reverdy
 // Contributor(s):  Vincent Reverdy [2020-]
 // License:         BSD 3-Clause License
 // ========================================================================== //
-#ifndef _BASE_HPP_INCLUDED
-#define _BASE_HPP_INCLUDED
+#ifndef _BASES_HPP_INCLUDED
+#define _BASES_HPP_INCLUDED
 // ========================================================================== //
 
 
 
 // ============================== PREAMBLE ================================== //
 // C++ standard library
-#include <tuple>
+#include <limits>
 #include <vector>
-#include <iterators>
+#include <cassert>
+#include <cstdint>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <functional>
+#include <type_traits>
 // Project sources
+#include "traits.hpp"
 // Third-party libraries
 // Miscellaneous
 namespace epidesim {
 // ========================================================================== //
 
-children
-parent
 
-preorder_dfs
-postorder_dfs
-inorder_dfs
 
-depth_first_search
-breadth_first_search
+// ============================= TREE TRAVERSALS ============================ //
+// Traversal of the children of a node
+struct children {};
+
+// Traversal of the ancestors of a node, from its parent to the root
+struct ancestors {};
+
+// Traversal of the siblings of a node, excluding the node itself
+struct siblings {};
+
+// Depth first order visiting a node before its children
+struct pre_order {};
+
+// Depth first order visiting a node after its first N children
+template <std::size_t N = 1>
+struct in_order {};
+
+// Depth first order visiting a node after all its children
+struct post_order {};
+
+// Depth first search in the provided order
+template <class Order>
+struct depth_first_search {};
+
+// Breadth first search
+struct breadth_first_search {};
+
+// Alias templates
+using preorder_dfs = depth_first_search<pre_order>;
+template <std::size_t N = 1>
+using inorder_dfs = depth_first_search<in_order<N>>;
+using postorder_dfs = depth_first_search<post_order>;
+// ========================================================================== //
+
+
+
+// ============================= ITERATOR RANGE ============================= //
+// A range delimited by a pair of iterators
+template <class Iterator, class Sentinel = Iterator>
+class iterator_range
+{
+    // Types
+    public:
+    using iterator = Iterator;
+    using sentinel = Sentinel;
+
+    // Lifecycle
+    public:
+    constexpr iterator_range() = default;
+    constexpr iterator_range(iterator first, sentinel last)
+    : _first(first), _last(last) {
+    }
+
+    // Access
+    public:
+    constexpr iterator begin() const {
+        return _first;
+    }
+    constexpr sentinel end() const {
+        return _last;
+    }
+    constexpr bool empty() const {
+        return _first == _last;
+    }
+
+    // Implementation details
+    private:
+    iterator _first;
+    sentinel _last;
+};
+// ========================================================================== //
+
+
+
+// ====================== TREE FORWARD DECLARATIONS ========================= //
+// Traversal policy of a tree
+template <class Traversal>
+struct tree_traversal;
+
+// Iterator over the nodes of a tree following a traversal
+template <class Tree, class Traversal>
+class tree_iterator;
+
+// Nodes of a tree grouped by depth
+template <class Container>
+struct tree_levels;
+// ========================================================================== //
 
 
 
 /* ********************************** TREE ********************************** */
-// A basic tree data structure
+// A tree stored as a flat arena: values live contiguously in the container,
+// and nodes are linked through 32-bit indices so that the whole structure can
+// be copied, relocated or serialized without any pointer fix-up; once
+// linearized, nodes are stored in depth first pre-order and the subtree of any
+// node spans the contiguous storage range starting at its index; parents are
+// always stored before their children, which lets aggregates be refreshed
+// bottom-up along the dirty paths only by visiting them in decreasing order
 template <class Type, class Container = std::vector<Type>>
 class tree
 {
@@ -44,78 +137,766 @@ class tree
     public:
     using value_type = Type;
     using container_type = Container;
+    using size_type = typename container_type::size_type;
+    using difference_type = typename container_type::difference_type;
+    using reference = typename container_type::reference;
+    using const_reference = typename container_type::const_reference;
+    using index_type = std::uint32_t;
     class node;
-    template <class>
-    class iterator;
+    using node_container_type = rebind_container_t<container_type, node>;
+    using index_container_type = rebind_container_t<container_type, index_type>;
+    using flag_container_type = rebind_container_t<container_type, char>;
+    using storage_iterator = typename container_type::iterator;
+    using const_storage_iterator = typename container_type::const_iterator;
+    template <class Traversal>
+    using iterator = tree_iterator<tree, Traversal>;
+    template <class Traversal>
+    using const_iterator = tree_iterator<const tree, Traversal>;
+    template <class Traversal>
+    using range_type = iterator_range<iterator<Traversal>>;
+    template <class Traversal>
+    using const_range_type = iterator_range<const_iterator<Traversal>>;
+    using subtree_type = iterator_range<storage_iterator>;
+    using const_subtree_type = iterator_range<const_storage_iterator>;
+    using levels_type = tree_levels<index_container_type>;
+
+    // Constants
+    public:
+    static constexpr index_type npos = std::numeric_limits<index_type>::max();
+
+    // Lifecycle
+    public:
+    tree() = default;
+    template <class... Args>
+    explicit tree(std::in_place_t, Args&&... args) {
+        emplace_root(std::forward<Args>(args)...);
+    }
+
+    // Capacity
+    public:
+    bool empty() const noexcept {
+        return _values.empty();
+    }
+    size_type size() const noexcept {
+        return _values.size();
+    }
+    size_type max_size() const noexcept {
+        const size_type limit = npos;
+        return std::min({_values.max_size(), _nodes.max_size(), limit});
+    }
+    void reserve(size_type count) {
+        _values.reserve(count);
+        _nodes.reserve(count);
+    }
+    void clear() noexcept {
+        _values.clear();
+        _nodes.clear();
+        _sizes.clear();
+        _dirty.clear();
+        _touched.clear();
+    }
+
+    // Modifiers
+    public:
+    template <class... Args>
+    index_type emplace_root(Args&&... args) {
+        assert(empty());
+        _values.emplace_back(std::forward<Args>(args)...);
+        _nodes.emplace_back();
+        _sizes.clear();
+        _dirty.emplace_back(false);
+        touch(root());
+        return root();
+    }
+    template <class... Args>
+    index_type emplace_child(index_type parent, Args&&... args) {
+        assert(parent < size() && size() < max_size());
+        const index_type index = static_cast<index_type>(size());
+        _values.emplace_back(std::forward<Args>(args)...);
+        _nodes.emplace_back();
+        _sizes.clear();
+        node& ancestor = _nodes[parent];
+        _nodes[index]._parent = parent;
+        if (ancestor._last_child == npos) {
+            ancestor._first_child = index;
+        } else {
+            _nodes[ancestor._last_child]._next_sibling = index;
+        }
+        ancestor._last_child = index;
+        _dirty.emplace_back(false);
+        touch(index);
+        return index;
+    }
+
+    // Element access
+    public:
+    reference operator[](index_type index) {
+        return _values[index];
+    }
+    const_reference operator[](index_type index) const {
+        return _values[index];
+    }
+    const container_type& values() const noexcept {
+        return _values;
+    }
+    const node_container_type& nodes() const noexcept {
+        return _nodes;
+    }
+
+    // Structure
+    public:
+    static constexpr index_type root() noexcept {
+        return 0;
+    }
+    index_type parent(index_type index) const noexcept {
+        return _nodes[index]._parent;
+    }
+    index_type first_child(index_type index) const noexcept {
+        return _nodes[index]._first_child;
+    }
+    index_type last_child(index_type index) const noexcept {
+        return _nodes[index]._last_child;
+    }
+    index_type next_sibling(index_type index) const noexcept {
+        return _nodes[index]._next_sibling;
+    }
+    bool is_root(index_type index) const noexcept {
+        return _nodes[index]._parent == npos;
+    }
+    bool is_leaf(index_type index) const noexcept {
+        return _nodes[index]._first_child == npos;
+    }
+    size_type degree(index_type index) const noexcept {
+        size_type count = 0;
+        index = _nodes[index]._first_child;
+        for (; index != npos; index = _nodes[index]._next_sibling) {
+            ++count;
+        }
+        return count;
+    }
+
+    // Linearization
+    public:
+    index_container_type linearize() {
+        const size_type count = size();
+        index_container_type order;
+        index_container_type indices(count, npos);
+        container_type values;
+        node_container_type nodes(count);
+        order.reserve(count);
+        values.reserve(count);
+        const auto traversal = range<preorder_dfs>();
+        for (auto it = traversal.begin(); it != traversal.end(); ++it) {
+            indices[it.index()] = static_cast<index_type>(order.size());
+            order.push_back(it.index());
+        }
+        const auto relink = [&indices](index_type index) noexcept {
+            return index != npos ? indices[index] : npos;
+        };
+        for (size_type i = 0; i < count; ++i) {
+            const node& former = _nodes[order[i]];
+            values.push_back(std::move(_values[order[i]]));
+            nodes[i]._parent = relink(former._parent);
+            nodes[i]._first_child = relink(former._first_child);
+            nodes[i]._last_child = relink(former._last_child);
+            nodes[i]._next_sibling = relink(former._next_sibling);
+        }
+        _values = std::move(values);
+        _nodes = std::move(nodes);
+        for (size_type i = 0; i < _touched.size(); ++i) {
+            _touched[i] = indices[_touched[i]];
+        }
+        for (size_type i = 0; i < count; ++i) {
+            _dirty[i] = false;
+        }
+        for (size_type i = 0; i < _touched.size(); ++i) {
+            _dirty[_touched[i]] = true;
+        }
+        _sizes.assign(count, 1);
+        for (size_type i = count; i > 1; --i) {
+            _sizes[_nodes[i - 1]._parent] += _sizes[i - 1];
+        }
+        return indices;
+    }
+    bool is_linearized() const noexcept {
+        return !empty() && _sizes.size() == size();
+    }
+    size_type subtree_size(index_type index) const noexcept {
+        assert(is_linearized());
+        return _sizes[index];
+    }
+    subtree_type subtree_range(index_type index) noexcept {
+        const storage_iterator first = begin() + index;
+        return subtree_type(first, first + subtree_size(index));
+    }
+    const_subtree_type subtree_range(index_type index) const noexcept {
+        const const_storage_iterator first = begin() + index;
+        return const_subtree_type(first, first + subtree_size(index));
+    }
+
+    // Reductions
+    public:
+    levels_type levels() const {
+        levels_type result;
+        index_container_type depths(size(), 0);
+        index_type height = 0;
+        for (size_type i = 1; i < size(); ++i) {
+            depths[i] = depths[_nodes[i]._parent] + 1;
+            height = std::max(height, depths[i]);
+        }
+        result.offsets.assign(empty() ? 0 : height + size_type(2), 0);
+        for (size_type i = 0; i < size(); ++i) {
+            ++result.offsets[depths[i] + 1];
+        }
+        for (size_type i = 1; i < result.offsets.size(); ++i) {
+            result.offsets[i] += result.offsets[i - 1];
+        }
+        result.nodes.resize(size());
+        for (index_type i = 0; i < size(); ++i) {
+            result.nodes[result.offsets[depths[i]]++] = i;
+        }
+        for (size_type i = result.offsets.size(); i > 1; --i) {
+            result.offsets[i - 1] = result.offsets[i - 2];
+        }
+        if (!empty()) {
+            result.offsets.front() = 0;
+        }
+        return result;
+    }
+    template <class Output, class Transform, class Combine>
+    void reduce(Output& output, Transform transform, Combine combine) const {
+        const auto traversal = range<postorder_dfs>();
+        for (auto it = traversal.begin(); it != traversal.end(); ++it) {
+            _reduce(it.index(), output, transform, combine);
+        }
+    }
+    template <class Executor, class Output, class Transform, class Combine>
+    void parallel_reduce(
+        Executor& executor,
+        Output& output,
+        Transform transform,
+        Combine combine
+    ) const {
+        parallel_reduce(executor, levels(), output, transform, combine);
+    }
+    template <class Executor, class Output, class Transform, class Combine>
+    void parallel_reduce(
+        Executor& executor,
+        const levels_type& levels,
+        Output& output,
+        Transform transform,
+        Combine combine
+    ) const {
+        const index_container_type& nodes = levels.nodes;
+        const index_container_type& offsets = levels.offsets;
+        for (size_type level = levels.size(); level > 0; --level) {
+            const size_type first = offsets[level - 1];
+            const size_type last = offsets[level];
+            executor.parallel_for(first, last, [&](size_type i) {
+                _reduce(nodes[i], output, transform, combine);
+            });
+        }
+    }
+
+    // Incremental reductions
+    public:
+    bool is_dirty(index_type index) const noexcept {
+        return _dirty[index];
+    }
+    size_type dirty_count() const noexcept {
+        return _touched.size();
+    }
+    void touch(index_type index) {
+        for (; index != npos && !_dirty[index]; index = parent(index)) {
+            _dirty[index] = true;
+            _touched.push_back(index);
+        }
+    }
+    template <class Output, class Transform, class Combine>
+    void refresh(Output& output, Transform transform, Combine combine) {
+        std::sort(_touched.begin(), _touched.end(), std::greater<>());
+        for (size_type i = 0; i < _touched.size(); ++i) {
+            _reduce(_touched[i], output, transform, combine);
+            _dirty[_touched[i]] = false;
+        }
+        _touched.clear();
+    }
+
+    // Storage order iterators
+    public:
+    storage_iterator begin() noexcept {
+        return _values.begin();
+    }
+    const_storage_iterator begin() const noexcept {
+        return _values.begin();
+    }
+    const_storage_iterator cbegin() const noexcept {
+        return _values.cbegin();
+    }
+    storage_iterator end() noexcept {
+        return _values.end();
+    }
+    const_storage_iterator end() const noexcept {
+        return _values.end();
+    }
+    const_storage_iterator cend() const noexcept {
+        return _values.cend();
+    }
+
+    // Traversal iterators
+    public:
+    template <class Traversal>
+    iterator<Traversal> begin(index_type index = root()) noexcept {
+        return index < size()
+        ? iterator<Traversal>(*this, index)
+        : end<Traversal>();
+    }
+    template <class Traversal>
+    const_iterator<Traversal> begin(index_type index = root()) const noexcept {
+        return cbegin<Traversal>(index);
+    }
+    template <class Traversal>
+    const_iterator<Traversal> cbegin(index_type index = root()) const noexcept {
+        return index < size()
+        ? const_iterator<Traversal>(*this, index)
+        : cend<Traversal>();
+    }
+    template <class Traversal>
+    iterator<Traversal> end(index_type = root()) noexcept {
+        return iterator<Traversal>();
+    }
+    template <class Traversal>
+    const_iterator<Traversal> end(index_type = root()) const noexcept {
+        return const_iterator<Traversal>();
+    }
+    template <class Traversal>
+    const_iterator<Traversal> cend(index_type = root()) const noexcept {
+        return const_iterator<Traversal>();
+    }
+    template <class Traversal>
+    range_type<Traversal> range(index_type index = root()) noexcept {
+        return range_type<Traversal>(begin<Traversal>(index), end<Traversal>());
+    }
+    template <class Traversal>
+    const_range_type<Traversal> range(
+        index_type index = root()
+    ) const noexcept {
+        return const_range_type<Traversal>(
+            cbegin<Traversal>(index),
+            cend<Traversal>()
+        );
+    }
+
+    // Implementation details
+    private:
+    template <class Output, class Transform, class Combine>
+    void _reduce(
+        index_type index,
+        Output& output,
+        Transform& transform,
+        Combine& combine
+    ) const {
+        remove_cvref_t<decltype(output[index])> result = transform(
+            _values[index]
+        );
+        index_type child = _nodes[index]._first_child;
+        for (; child != npos; child = _nodes[child]._next_sibling) {
+            result = combine(std::move(result), output[child]);
+        }
+        output[index] = std::move(result);
+    }
+    container_type _values;
+    node_container_type _nodes;
+    index_container_type _sizes;
+    flag_container_type _dirty;
+    index_container_type _touched;
 };
 /* ************************************************************************** */
 
 
 
 /* ********************************** NODE ********************************** */
-// The node type of a tree
+// The node type of a tree, holding the indices linking it to its relatives
 template <class Type, class Container>
 class tree<Type, Container>::node
 {
+    // Friendship
+    friend class tree<Type, Container>;
+
     // Types
     public:
     using tree_type = tree<Type, Container>;
-    using value_type = typename tree_type::value_type;
-    using container_type = typename tree_type::container_type;
+    using index_type = typename tree_type::index_type;
 
+    // Access
     public:
-    constexpr value_type&
+    constexpr index_type parent() const noexcept {
+        return _parent;
+    }
+    constexpr index_type first_child() const noexcept {
+        return _first_child;
+    }
+    constexpr index_type last_child() const noexcept {
+        return _last_child;
+    }
+    constexpr index_type next_sibling() const noexcept {
+        return _next_sibling;
+    }
 
-    template<class T>
-    constexpr begin<T>
-    
-    //
-    public:
-    value_type _value;
-    
+    // Implementation details
+    private:
+    index_type _parent = tree_type::npos;
+    index_type _first_child = tree_type::npos;
+    index_type _last_child = tree_type::npos;
+    index_type _next_sibling = tree_type::npos;
 };
 /* ************************************************************************** */
 
 
 
-/* ******************************** ITERATOR ******************************** */
-template <class Type, class Container>
-class tree<Type, Container>::iterator<children>
+/* ******************************* TREE LEVELS ****************************** */
+// Nodes of a tree grouped by depth, in storage order within each level, so
+// that every level can be processed as an independent parallel wavefront
+template <class Container>
+struct tree_levels
 {
-    
+    // Types
+    public:
+    using container_type = Container;
+    using size_type = typename container_type::size_type;
+    using const_iterator = typename container_type::const_iterator;
+    using level_type = iterator_range<const_iterator>;
+
+    // Access
+    public:
+    size_type size() const noexcept {
+        return offsets.empty() ? 0 : offsets.size() - 1;
+    }
+    level_type operator[](size_type level) const noexcept {
+        return level_type(
+            nodes.begin() + offsets[level],
+            nodes.begin() + offsets[level + 1]
+        );
+    }
+
+    // Data members
+    public:
+    container_type nodes;
+    container_type offsets;
 };
+/* ************************************************************************** */
 
-template <class Type, class Container>
-class tree<Type, Container>::iterator<ancestors>
-{
-    
+
+
+/* **************************** TREE TRAVERSALS ***************************** */
+// Traversal policies only follow the links of the nodes: they never allocate,
+// and only keep a single auxiliary index in addition to the current node and
+// the origin of the traversal
+
+// Traversal of the children of a node
+template <>
+struct tree_traversal<children> {
+    template <class Tree, class Index = typename Tree::index_type>
+    static Index first(const Tree& tree, Index origin, Index&) noexcept {
+        return tree.first_child(origin);
+    }
+    template <class Tree, class Index = typename Tree::index_type>
+    static Index next(const Tree& tree, Index current, Index, Index&) noexcept {
+        return tree.next_sibling(current);
+    }
 };
 
-template <class Type, class Container>
-class tree<Type, Container>::iterator<siblings>
-{
-    
+// Traversal of the ancestors of a node, from its parent to the root
+template <>
+struct tree_traversal<ancestors> {
+    template <class Tree, class Index = typename Tree::index_type>
+    static Index first(const Tree& tree, Index origin, Index&) noexcept {
+        return tree.parent(origin);
+    }
+    template <class Tree, class Index = typename Tree::index_type>
+    static Index next(const Tree& tree, Index current, Index, Index&) noexcept {
+        return tree.parent(current);
+    }
 };
 
-template <class Type, class Container>
-class tree<Type, Container>::iterator<breadth_first_search>
-{
+// Traversal of the siblings of a node, excluding the node itself
+template <>
+struct tree_traversal<siblings> {
+    template <class Tree, class Index = typename Tree::index_type>
+    static Index first(const Tree& tree, Index origin, Index&) noexcept {
+        const Index parent = tree.parent(origin);
+        const Index current = parent != Tree::npos
+        ? tree.first_child(parent)
+        : Tree::npos;
+        return current == origin ? tree.next_sibling(current) : current;
+    }
+    template <class Tree, class Index = typename Tree::index_type>
+    static Index next(
+        const Tree& tree,
+        Index current,
+        Index origin,
+        Index&
+    ) noexcept {
+        current = tree.next_sibling(current);
+        return current == origin ? tree.next_sibling(current) : current;
+    }
 };
 
-template <class Type, class Container>
-class tree<Type, Container>::iterator<depth_first_search<pre_order>>
-{
+// Traversal of a subtree in depth first pre-order
+template <>
+struct tree_traversal<depth_first_search<pre_order>> {
+    template <class Tree, class Index = typename Tree::index_type>
+    static Index first(const Tree&, Index origin, Index&) noexcept {
+        return origin;
+    }
+    template <class Tree, class Index = typename Tree::index_type>
+    static Index next(
+        const Tree& tree,
+        Index current,
+        Index origin,
+        Index&
+    ) noexcept {
+        if (!tree.is_leaf(current)) {
+            return tree.first_child(current);
+        }
+        for (; current != origin; current = tree.parent(current)) {
+            if (tree.next_sibling(current) != Tree::npos) {
+                return tree.next_sibling(current);
+            }
+        }
+        return Tree::npos;
+    }
 };
 
-template <class Type, class Container>
+// Traversal of a subtree in depth first in-order, after the first N children
 template <std::size_t N>
-class tree<Type, Container>::iterator<depth_first_search<in_order<N>>>
-{
+struct tree_traversal<depth_first_search<in_order<N>>> {
+    template <class Tree, class Index = typename Tree::index_type>
+    static Index enter(const Tree& tree, Index current) noexcept {
+        while (N > 0 && !tree.is_leaf(current)) {
+            current = tree.first_child(current);
+        }
+        return current;
+    }
+    template <class Tree, class Index = typename Tree::index_type>
+    static std::size_t rank(const Tree& tree, Index current) noexcept {
+        std::size_t count = 0;
+        Index sibling = tree.first_child(tree.parent(current));
+        for (; sibling != current && count < N; ++count) {
+            sibling = tree.next_sibling(sibling);
+        }
+        return count;
+    }
+    template <class Tree, class Index = typename Tree::index_type>
+    static Index first(const Tree& tree, Index origin, Index&) noexcept {
+        return enter(tree, origin);
+    }
+    template <class Tree, class Index = typename Tree::index_type>
+    static Index next(
+        const Tree& tree,
+        Index current,
+        Index origin,
+        Index&
+    ) noexcept {
+        Index child = tree.first_child(current);
+        for (std::size_t i = 0; i < N && child != Tree::npos; ++i) {
+            child = tree.next_sibling(child);
+        }
+        if (child != Tree::npos) {
+            return enter(tree, child);
+        }
+        for (; current != origin; current = tree.parent(current)) {
+            const std::size_t count = rank(tree, current);
+            const Index sibling = tree.next_sibling(current);
+            if (count + 1 == N || (count < N && sibling == Tree::npos)) {
+                return tree.parent(current);
+            } else if (sibling != Tree::npos) {
+                return enter(tree, sibling);
+            }
+        }
+        return Tree::npos;
+    }
 };
 
-template <class Type, class Container>
-class tree<Type, Container>::iterator<depth_first_search<post_order>>
+// Traversal of a subtree in depth first post-order
+template <>
+struct tree_traversal<depth_first_search<post_order>> {
+    template <class Tree, class Index = typename Tree::index_type>
+    static Index enter(const Tree& tree, Index current) noexcept {
+        while (!tree.is_leaf(current)) {
+            current = tree.first_child(current);
+        }
+        return current;
+    }
+    template <class Tree, class Index = typename Tree::index_type>
+    static Index first(const Tree& tree, Index origin, Index&) noexcept {
+        return enter(tree, origin);
+    }
+    template <class Tree, class Index = typename Tree::index_type>
+    static Index next(
+        const Tree& tree,
+        Index current,
+        Index origin,
+        Index&
+    ) noexcept {
+        if (current == origin) {
+            return Tree::npos;
+        } else if (tree.next_sibling(current) != Tree::npos) {
+            return enter(tree, tree.next_sibling(current));
+        }
+        return tree.parent(current);
+    }
+};
+
+// Traversal of a subtree in breadth first order: levels are rediscovered with
+// a depth-limited walk instead of a queue, which keeps the iterator
+// allocation-free but rescans the upper levels of the subtree for each new
+// level, so that a whole traversal costs O(size * height) steps in the worst
+// case, and a single increment up to O(size)
+template <>
+struct tree_traversal<breadth_first_search> {
+    template <class Tree, class Index = typename Tree::index_type>
+    static Index find(
+        const Tree& tree,
+        Index current,
+        Index origin,
+        Index depth,
+        Index target
+    ) noexcept {
+        constexpr Index npos = Tree::npos;
+        do {
+            if (depth < target && !tree.is_leaf(current)) {
+                current = tree.first_child(current);
+                ++depth;
+            } else {
+                while (
+                    current != origin && tree.next_sibling(current) == npos
+                ) {
+                    current = tree.parent(current);
+                    --depth;
+                }
+                if (current == origin) {
+                    return npos;
+                }
+                current = tree.next_sibling(current);
+            }
+        } while (depth != target);
+        return current;
+    }
+    template <class Tree, class Index = typename Tree::index_type>
+    static Index first(const Tree&, Index origin, Index& depth) noexcept {
+        depth = 0;
+        return origin;
+    }
+    template <class Tree, class Index = typename Tree::index_type>
+    static Index next(
+        const Tree& tree,
+        Index current,
+        Index origin,
+        Index& depth
+    ) noexcept {
+        constexpr Index npos = Tree::npos;
+        current = depth ? find(tree, current, origin, depth, depth) : npos;
+        if (current == npos) {
+            current = find(tree, origin, origin, Index(0), ++depth);
+        }
+        return current;
+    }
+};
+/* ************************************************************************** */
+
+
+
+/* ****************************** TREE ITERATOR ***************************** */
+// A forward iterator over the values of a tree following a traversal
+template <class Tree, class Traversal>
+class tree_iterator
 {
+    // Friendship
+    template <class, class>
+    friend class tree_iterator;
+
+    // Types
+    public:
+    using tree_type = Tree;
+    using traversal_type = Traversal;
+    using index_type = typename tree_type::index_type;
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = typename tree_type::value_type;
+    using difference_type = std::ptrdiff_t;
+    using reference = decltype(std::declval<tree_type&>()[index_type()]);
+    using pointer = std::add_pointer_t<reference>;
+
+    // Helpers
+    private:
+    using policy = tree_traversal<traversal_type>;
+    template <class Other>
+    using if_convertible_t = std::enable_if_t<
+        std::is_convertible_v<Other*, tree_type*>
+    >;
+
+    // Lifecycle
+    public:
+    constexpr tree_iterator() noexcept = default;
+    tree_iterator(tree_type& tree, index_type origin) noexcept
+    : _tree(&tree), _origin(origin) {
+        _index = policy::first(tree, origin, _auxiliary);
+    }
+    template <class Other, class = if_convertible_t<Other>>
+    constexpr tree_iterator(
+        const tree_iterator<Other, Traversal>& other
+    ) noexcept
+    : _tree(other._tree)
+    , _index(other._index)
+    , _origin(other._origin)
+    , _auxiliary(other._auxiliary) {
+    }
+
+    // Access
+    public:
+    reference operator*() const {
+        return (*_tree)[_index];
+    }
+    pointer operator->() const {
+        return std::addressof(**this);
+    }
+    constexpr index_type index() const noexcept {
+        return _index;
+    }
+
+    // Increment
+    public:
+    tree_iterator& operator++() noexcept {
+        _index = policy::next(*_tree, _index, _origin, _auxiliary);
+        return *this;
+    }
+    tree_iterator operator++(int) noexcept {
+        tree_iterator self = *this;
+        ++*this;
+        return self;
+    }
+
+    // Comparison
+    public:
+    friend constexpr bool operator==(
+        const tree_iterator& lhs,
+        const tree_iterator& rhs
+    ) noexcept {
+        return lhs._index == rhs._index;
+    }
+    friend constexpr bool operator!=(
+        const tree_iterator& lhs,
+        const tree_iterator& rhs
+    ) noexcept {
+        return lhs._index != rhs._index;
+    }
+
+    // Implementation details
+    private:
+    tree_type* _tree = nullptr;
+    index_type _index = tree_type::npos;
+    index_type _origin = tree_type::npos;
+    index_type _auxiliary = 0;
 };
 /* ************************************************************************** */
 
@@ -123,5 +904,5 @@ class tree<Type, Container>::iterator<depth_first_search<post_order>>
 
 // ========================================================================== //
 } // namespace epidesim
-#endif // _TREE_HPP_INCLUDED
+#endif // _BASES_HPP_INCLUDED
 // ========================================================================== //
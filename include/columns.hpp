@@ -0,0 +1,325 @@
+// ================================= COLUMNS ================================ //
+// Project:         epidesim
+// Name:            columns.hpp
+// Description:     Compact columns of agent attributes
+// Creator:         Vincent Reverdy
+// Contributor(s):  Vincent Reverdy [2020-]
+// License:         BSD 3-Clause License
+// ========================================================================== //
+#ifndef _COLUMNS_HPP_INCLUDED
+#define _COLUMNS_HPP_INCLUDED
+// ========================================================================== //
+
+
+
+// ============================== PREAMBLE ================================== //
+// C++ standard library
+#include <array>
+#include <limits>
+#include <vector>
+#include <cassert>
+#include <cstdint>
+#include <utility>
+#include <type_traits>
+// Project sources
+#include "pack.hpp"
+#include "traits.hpp"
+// Third-party libraries
+// Miscellaneous
+namespace epidesim {
+// ========================================================================== //
+
+
+
+// ================================ POPCOUNT ================================ //
+// Counts the number of bits set in a word
+constexpr std::size_t popcount(std::uint64_t word) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<std::size_t>(__builtin_popcountll(word));
+#else
+    word = word - ((word >> 1) & 0x5555555555555555ULL);
+    word = (word & 0x3333333333333333ULL)
+    + ((word >> 2) & 0x3333333333333333ULL);
+    word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return static_cast<std::size_t>((word * 0x0101010101010101ULL) >> 56);
+#endif
+}
+// ========================================================================== //
+
+
+
+// ============================ COMPARTMENT COLUMN ========================== //
+// A column of compartment states packed in 64-bit words: the states are the
+// values of a bool or nttp pack, each agent stores the index of its state on
+// the smallest power of two number of bits, so that lanes never straddle two
+// words and whole words can be counted and updated at once
+template <class States, class Container = std::vector<std::uint64_t>>
+class compartment_column
+{
+    // Types
+    public:
+    using states_type = States;
+    using value_type = typename pack_values<states_type>::value_type;
+    using container_type = Container;
+    using word_type = std::uint64_t;
+    using size_type = std::size_t;
+    using code_type = unsigned int;
+    class reference;
+
+    // Constants
+    public:
+    static constexpr size_type states = pack_size_v<states_type>;
+    static constexpr size_type bits = states <= 2 ? 1
+    : states <= 4 ? 2
+    : states <= 16 ? 4
+    : 8;
+    static constexpr size_type word_bits
+    = std::numeric_limits<word_type>::digits;
+    static constexpr size_type lanes = word_bits / bits;
+    static_assert(states > 0 && states <= 256, "unsupported number of states");
+    static_assert(
+        std::is_same_v<typename container_type::value_type, word_type>,
+        "compartment columns are stored in 64-bit words"
+    );
+
+    // Helpers
+    private:
+    static constexpr std::array<value_type, states> _values
+    = pack_values_v<states_type>;
+    static constexpr word_type _lane_mask = (word_type(1) << bits) - 1;
+    static constexpr word_type _low_bits = ~word_type(0) / _lane_mask;
+
+    // Lifecycle
+    public:
+    compartment_column() = default;
+    explicit compartment_column(size_type count, value_type value = _values[0])
+    : _words((count + lanes - 1) / lanes, _broadcast(code(value)))
+    , _size(count) {
+    }
+
+    // Capacity
+    public:
+    bool empty() const noexcept {
+        return _size == 0;
+    }
+    size_type size() const noexcept {
+        return _size;
+    }
+    void reserve(size_type count) {
+        _words.reserve((count + lanes - 1) / lanes);
+    }
+    void resize(size_type count, value_type value = _values[0]) {
+        const code_type c = code(value);
+        for (size_type i = _size; i < count && i % lanes; ++i) {
+            _set(i, c);
+        }
+        _words.resize((count + lanes - 1) / lanes, _broadcast(c));
+        _size = count;
+    }
+    void clear() noexcept {
+        _words.clear();
+        _size = 0;
+    }
+
+    // Modifiers
+    public:
+    void push_back(value_type value) {
+        if (_size % lanes == 0) {
+            _words.push_back(0);
+        }
+        _set(_size++, code(value));
+    }
+    void pop_back() {
+        if (--_size % lanes == 0) {
+            _words.pop_back();
+        }
+    }
+
+    // Element access
+    public:
+    reference operator[](size_type index) noexcept {
+        return reference(*this, index);
+    }
+    value_type operator[](size_type index) const noexcept {
+        return _values[_get(index)];
+    }
+    void set(size_type index, value_type value) noexcept {
+        _set(index, code(value));
+    }
+    const container_type& words() const noexcept {
+        return _words;
+    }
+
+    // Codes
+    public:
+    static constexpr code_type code(value_type value) noexcept {
+        code_type result = 0;
+        while (result + 1 < states && _values[result] != value) {
+            ++result;
+        }
+        assert(_values[result] == value);
+        return result;
+    }
+    static constexpr value_type state(code_type code) noexcept {
+        return _values[code];
+    }
+
+    // Reductions
+    public:
+    size_type count(value_type value) const noexcept {
+        const word_type pattern = _broadcast(code(value));
+        size_type result = 0;
+        for (size_type i = 0; i < _words.size(); ++i) {
+            result += popcount(_equal(_words[i], pattern) & _valid(i));
+        }
+        return result;
+    }
+    std::array<size_type, states> counts() const noexcept {
+        std::array<size_type, states> result = {};
+        for (size_type i = 0; i < _words.size(); ++i) {
+            const word_type word = _words[i];
+            const word_type valid = _valid(i);
+            for (code_type c = 0; c < states; ++c) {
+                result[c] += popcount(_equal(word, _broadcast(c)) & valid);
+            }
+        }
+        return result;
+    }
+    template <class Result = std::size_t>
+    Result sum() const noexcept {
+        const std::array<size_type, states> tally = counts();
+        Result result = Result();
+        for (code_type c = 0; c < states; ++c) {
+            result += static_cast<Result>(_values[c]) * static_cast<Result>(
+                tally[c]
+            );
+        }
+        return result;
+    }
+
+    // Transitions
+    public:
+    size_type transition(value_type from, value_type to) noexcept {
+        const word_type source = _broadcast(code(from));
+        const word_type target = _broadcast(code(to));
+        size_type result = 0;
+        for (size_type i = 0; i < _words.size(); ++i) {
+            const word_type selected = _equal(_words[i], source) & _valid(i);
+            const word_type mask = selected * _lane_mask;
+            _words[i] = (_words[i] & ~mask) | (target & mask);
+            result += popcount(selected);
+        }
+        return result;
+    }
+    template <class Mask>
+    size_type transition(value_type from, value_type to, const Mask& mask) {
+        const word_type source = _broadcast(code(from));
+        const word_type target = _broadcast(code(to));
+        size_type result = 0;
+        for (size_type i = 0; i < _words.size(); ++i) {
+            const size_type first = i * lanes;
+            const word_type selection = mask[first / word_bits] >> (
+                first % word_bits
+            );
+            const word_type selected = _equal(_words[i], source)
+            & _spread(selection) & _valid(i);
+            const word_type lanes_mask = selected * _lane_mask;
+            _words[i] = (_words[i] & ~lanes_mask) | (target & lanes_mask);
+            result += popcount(selected);
+        }
+        return result;
+    }
+
+    // Implementation details
+    private:
+    static constexpr word_type _broadcast(code_type code) noexcept {
+        return _low_bits * code;
+    }
+    static constexpr word_type _equal(word_type word, word_type pattern) {
+        word_type difference = word ^ pattern;
+        for (size_type shift = 1; shift < bits; shift *= 2) {
+            difference |= difference >> shift;
+        }
+        return ~difference & _low_bits;
+    }
+    static constexpr word_type _repeat(word_type pattern, size_type period) {
+        word_type result = 0;
+        for (size_type i = 0; i < word_bits; i += period) {
+            result |= pattern << i;
+        }
+        return result;
+    }
+    static constexpr word_type _spread(word_type word) noexcept {
+        word &= lanes < word_bits ? (word_type(1) << lanes) - 1 : ~word_type(0);
+        for (size_type group = lanes / 2; bits > 1 && group > 0; group /= 2) {
+            word = (word | (word << (group * (bits - 1))))
+            & _repeat((word_type(1) << group) - 1, group * bits);
+        }
+        return word;
+    }
+    word_type _valid(size_type word) const noexcept {
+        const size_type remaining = _size - word * lanes;
+        return remaining >= lanes
+        ? _low_bits
+        : _low_bits & ((word_type(1) << (remaining * bits)) - 1);
+    }
+    code_type _get(size_type index) const noexcept {
+        const size_type shift = (index % lanes) * bits;
+        return static_cast<code_type>(
+            (_words[index / lanes] >> shift) & _lane_mask
+        );
+    }
+    void _set(size_type index, code_type code) noexcept {
+        const size_type shift = (index % lanes) * bits;
+        word_type& word = _words[index / lanes];
+        word = (word & ~(_lane_mask << shift)) | (word_type(code) << shift);
+    }
+    container_type _words;
+    size_type _size = 0;
+};
+
+// A proxy reference to a state in a compartment column
+template <class States, class Container>
+class compartment_column<States, Container>::reference
+{
+    // Types
+    public:
+    using column_type = compartment_column<States, Container>;
+    using value_type = typename column_type::value_type;
+    using size_type = typename column_type::size_type;
+
+    // Lifecycle
+    public:
+    constexpr reference(column_type& column, size_type index) noexcept
+    : _column(&column), _index(index) {
+    }
+
+    // Assignment
+    public:
+    reference& operator=(value_type value) noexcept {
+        _column->set(_index, value);
+        return *this;
+    }
+    reference& operator=(const reference& other) noexcept {
+        return *this = static_cast<value_type>(other);
+    }
+
+    // Conversion
+    public:
+    operator value_type() const noexcept {
+        return static_cast<const column_type&>(*_column)[_index];
+    }
+
+    // Implementation details
+    private:
+    column_type* _column;
+    size_type _index;
+};
+// ========================================================================== //
+
+
+
+// ========================================================================== //
+} // namespace epidesim
+#endif // _COLUMNS_HPP_INCLUDED
+// ========================================================================== //
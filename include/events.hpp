@@ -0,0 +1,334 @@
+// ================================= EVENTS ================================= //
+// Project:         epidesim
+// Name:            events.hpp
+// Description:     Calendar queue and event-driven execution of simulations
+// Creator:         Vincent Reverdy
+// Contributor(s):  Vincent Reverdy [2020-]
+// License:         BSD 3-Clause License
+// ========================================================================== //
+#ifndef _EVENTS_HPP_INCLUDED
+#define _EVENTS_HPP_INCLUDED
+// ========================================================================== //
+
+
+
+// ============================== PREAMBLE ================================== //
+// C++ standard library
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+// Project sources
+#include "traits.hpp"
+// Third-party libraries
+// Miscellaneous
+namespace epidesim {
+// ========================================================================== //
+
+
+
+// ============================= CALENDAR QUEUE ============================= //
+// A calendar queue of timed events: time is cut into windows of a fixed
+// width, and the window of an event is stored in a bucket of a circular
+// array, so that inserting an event and popping the events of the earliest
+// window take constant amortized time. The buckets are doubled when the
+// queue holds more than four events per bucket, and a queue whose remaining
+// events all lie more than a full turn of buckets ahead jumps directly to the
+// earliest of them. Popping up to a time only returns the events strictly
+// before it, and stops in its window so that the later events of the window
+// remain in the queue. Times too large to be numbered as windows, including
+// infinities, fall in the last window
+template <
+    class Event = std::uint32_t,
+    class Time = double,
+    class Container = std::vector<Event>
+>
+class calendar_queue
+{
+    // Types
+    public:
+    using event_type = Event;
+    using time_type = Time;
+    struct value_type {
+        time_type time;
+        event_type event;
+    };
+    using bucket_type = rebind_container_t<Container, value_type>;
+    using buckets_type = rebind_container_t<Container, bucket_type>;
+    using size_type = std::size_t;
+    using window_type = std::int64_t;
+
+    // Constants
+    public:
+    static constexpr size_type default_buckets = 64;
+
+    // Lifecycle
+    public:
+    explicit calendar_queue(
+        time_type width = time_type(1),
+        size_type buckets = default_buckets
+    )
+    : _buckets(_round(buckets)), _width(width) {
+    }
+
+    // Capacity
+    public:
+    bool empty() const noexcept {
+        return _size == 0;
+    }
+    size_type size() const noexcept {
+        return _size;
+    }
+    size_type buckets() const noexcept {
+        return _buckets.size();
+    }
+    time_type width() const noexcept {
+        return _width;
+    }
+    time_type now() const noexcept {
+        return static_cast<time_type>(_window) * _width;
+    }
+    void clear() noexcept {
+        for (bucket_type& bucket: _buckets) {
+            bucket.clear();
+        }
+        _size = 0;
+    }
+
+    // Modifiers
+    public:
+    void push(time_type time, event_type event) {
+        assert(!std::isnan(time));
+        const window_type window = std::max(this->window(time), _window);
+        _buckets[window & (_buckets.size() - 1)].push_back({time, event});
+        if (++_size > 4 * _buckets.size()) {
+            _resize(2 * _buckets.size());
+        }
+    }
+    template <class Output>
+    bool pop(
+        Output& output,
+        time_type until = std::numeric_limits<time_type>::infinity()
+    ) {
+        const window_type last = window(until);
+        output.clear();
+        while (_size > 0 && _window <= last) {
+            for (size_type i = 0; i < _buckets.size(); ++i) {
+                if (_extract(output, until)) {
+                    return true;
+                } else if (_window == last) {
+                    return false;
+                }
+                ++_window;
+            }
+            _window = std::max(_window, std::min(_earliest(), last));
+        }
+        return false;
+    }
+    window_type window(time_type time) const noexcept {
+        constexpr time_type lowest = static_cast<time_type>(
+            std::numeric_limits<window_type>::min()
+        );
+        constexpr time_type highest = static_cast<time_type>(
+            std::numeric_limits<window_type>::max()
+        );
+        const time_type result = std::floor(time / _width);
+        return !(result < highest) ? std::numeric_limits<window_type>::max()
+        : result <= lowest ? std::numeric_limits<window_type>::min()
+        : static_cast<window_type>(result);
+    }
+
+    // Implementation details
+    private:
+    static size_type _round(size_type count) noexcept {
+        size_type result = 1;
+        while (result < count) {
+            result *= 2;
+        }
+        return result;
+    }
+    template <class Output>
+    bool _extract(Output& output, time_type until) {
+        bucket_type& bucket = _buckets[_window & (_buckets.size() - 1)];
+        size_type kept = 0;
+        for (size_type i = 0; i < bucket.size(); ++i) {
+            if (window(bucket[i].time) <= _window && bucket[i].time < until) {
+                output.push_back(bucket[i]);
+            } else {
+                bucket[kept++] = bucket[i];
+            }
+        }
+        bucket.resize(kept);
+        _size -= output.size();
+        return !output.empty();
+    }
+    window_type _earliest() const noexcept {
+        window_type result = std::numeric_limits<window_type>::max();
+        for (const bucket_type& bucket: _buckets) {
+            for (const value_type& value: bucket) {
+                result = std::min(result, window(value.time));
+            }
+        }
+        return result;
+    }
+    void _resize(size_type count) {
+        buckets_type buckets(count);
+        for (bucket_type& bucket: _buckets) {
+            for (const value_type& value: bucket) {
+                const window_type window = std::max(
+                    this->window(value.time),
+                    _window
+                );
+                buckets[window & (count - 1)].push_back(value);
+            }
+        }
+        _buckets = std::move(buckets);
+    }
+    buckets_type _buckets;
+    time_type _width;
+    window_type _window = 0;
+    size_type _size = 0;
+};
+// ========================================================================== //
+
+
+
+// ============================== EVENT ENGINE ============================== //
+// An event-driven execution of a simulation: each agent schedules its next
+// event, such as the end of its stay in a compartment, and only the agents
+// whose events fall in the current window of time are processed, in batches
+// sorted by agent index. The handler of an event receives the simulation,
+// which it reads and updates in place through the columns of its schema, the
+// agent and the time of the event, and returns the time of the next event of
+// the agent, or never. Advancing up to a time processes the events strictly
+// before it, including the ones scheduled by handlers on the way. The same
+// simulation can alternate between ticks and events since both act on the
+// same columns
+template <class Simulation, class Time = double>
+class event_engine
+{
+    // Types
+    public:
+    using simulation_type = Simulation;
+    using time_type = Time;
+    using index_type = std::uint32_t;
+    using queue_type = calendar_queue<index_type, time_type>;
+    using event_type = typename queue_type::value_type;
+    using size_type = std::size_t;
+
+    // Constants
+    public:
+    static constexpr time_type never = std::numeric_limits<time_type>::max();
+
+    // Lifecycle
+    public:
+    explicit event_engine(
+        simulation_type& simulation,
+        time_type width = time_type(1)
+    )
+    : _simulation(&simulation), _queue(width) {
+    }
+
+    // Access
+    public:
+    simulation_type& simulation() const noexcept {
+        return *_simulation;
+    }
+    const queue_type& queue() const noexcept {
+        return _queue;
+    }
+    time_type now() const noexcept {
+        return _queue.now();
+    }
+    size_type pending() const noexcept {
+        return _queue.size();
+    }
+
+    // Scheduling
+    public:
+    void schedule(index_type agent, time_type time) {
+        if (time < never) {
+            _queue.push(time, agent);
+        }
+    }
+
+    // Execution
+    public:
+    template <class Handler>
+    size_type advance(time_type until, Handler&& handler) {
+        size_type result = 0;
+        while (_queue.pop(_batch, until)) {
+            _sort();
+            for (const event_type& event: _batch) {
+                schedule(event.event, handler(
+                    *_simulation,
+                    event.event,
+                    event.time
+                ));
+            }
+            result += _batch.size();
+        }
+        return result;
+    }
+    template <class Executor, class Handler>
+    size_type advance(Executor& executor, time_type until, Handler&& handler) {
+        constexpr index_type block = 64;
+        size_type result = 0;
+        while (_queue.pop(_batch, until)) {
+            _sort();
+            _groups.clear();
+            for (size_type i = 0; i < _batch.size(); ++i) {
+                if (i == 0 || _batch[i].event / block
+                    != _batch[i - 1].event / block) {
+                    _groups.push_back(i);
+                }
+            }
+            _groups.push_back(_batch.size());
+            _next.resize(_batch.size());
+            executor.parallel_for(0, _groups.size() - 1, 1, [&](size_type g) {
+                for (size_type i = _groups[g]; i < _groups[g + 1]; ++i) {
+                    _next[i] = handler(
+                        *_simulation,
+                        _batch[i].event,
+                        _batch[i].time
+                    );
+                }
+            });
+            for (size_type i = 0; i < _batch.size(); ++i) {
+                schedule(_batch[i].event, _next[i]);
+            }
+            result += _batch.size();
+        }
+        return result;
+    }
+
+    // Implementation details
+    private:
+    void _sort() {
+        std::sort(_batch.begin(), _batch.end(), [](
+            const event_type& lhs,
+            const event_type& rhs
+        ) {
+            return lhs.event < rhs.event
+            || (lhs.event == rhs.event && lhs.time < rhs.time);
+        });
+    }
+    simulation_type* _simulation;
+    queue_type _queue;
+    std::vector<event_type> _batch;
+    std::vector<size_type> _groups;
+    std::vector<time_type> _next;
+};
+// ========================================================================== //
+
+
+
+// ========================================================================== //
+} // namespace epidesim
+#endif // _EVENTS_HPP_INCLUDED
+// ========================================================================== //
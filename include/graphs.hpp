@@ -0,0 +1,530 @@
+// ================================= GRAPHS ================================= //
+// Project:         epidesim
+// Name:            graphs.hpp
+// Description:     Compressed sparse multi-layer contact graphs
+// Creator:         Vincent Reverdy
+// Contributor(s):  Vincent Reverdy [2020-]
+// License:         BSD 3-Clause License
+// ========================================================================== //
+#ifndef _GRAPHS_HPP_INCLUDED
+#define _GRAPHS_HPP_INCLUDED
+// ========================================================================== //
+
+
+
+// ============================== PREAMBLE ================================== //
+// C++ standard library
+#include <array>
+#include <tuple>
+#include <limits>
+#include <vector>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <iterator>
+#include <type_traits>
+// Project sources
+#include "pack.hpp"
+#include "bases.hpp"
+#include "traits.hpp"
+// Third-party libraries
+// Miscellaneous
+namespace epidesim {
+// ========================================================================== //
+
+
+
+// ============================== CONTACT EDGE ============================== //
+// An edge of a contact graph as seen from its source: weighted
+template <class Index, class Weight = void>
+struct contact_edge {
+    using index_type = Index;
+    using weight_type = Weight;
+    index_type target;
+    weight_type weight;
+};
+
+// An edge of a contact graph as seen from its source: unweighted
+template <class Index>
+struct contact_edge<Index, void> {
+    using index_type = Index;
+    using weight_type = void;
+    index_type target;
+};
+// ========================================================================== //
+
+
+
+// ============================ CONTACT ITERATOR ============================ //
+// An iterator over the edges leaving a vertex of a contact graph, reading the
+// target and the weight of each edge from their separate columns: edges are
+// assembled on the fly and returned by value as proxy references, with a
+// proxy pointer for member access, so that the iterator keeps the random
+// access category as the iterators of packed vectors of booleans do
+template <class Index, class Weight = void>
+class contact_iterator
+{
+    // Types
+    public:
+    using index_type = Index;
+    using weight_type = Weight;
+    using iterator_category = std::random_access_iterator_tag;
+    using iterator_concept = std::random_access_iterator_tag;
+    using value_type = contact_edge<index_type, weight_type>;
+    using difference_type = std::ptrdiff_t;
+    using reference = value_type;
+    class pointer;
+
+    // Helpers
+    private:
+    using weight_pointer = std::conditional_t<
+        std::is_void_v<weight_type>,
+        std::nullptr_t,
+        std::add_pointer_t<std::add_const_t<weight_type>>
+    >;
+
+    // Lifecycle
+    public:
+    constexpr contact_iterator() noexcept = default;
+    constexpr contact_iterator(
+        const index_type* target,
+        weight_pointer weight = nullptr
+    ) noexcept
+    : _target(target), _weight(weight) {
+    }
+
+    // Access
+    public:
+    constexpr reference operator*() const noexcept {
+        if constexpr (std::is_void_v<weight_type>) {
+            return reference{*_target};
+        } else {
+            return reference{*_target, *_weight};
+        }
+    }
+    constexpr pointer operator->() const noexcept {
+        return pointer(**this);
+    }
+    constexpr reference operator[](difference_type n) const noexcept {
+        return *(*this + n);
+    }
+    constexpr const index_type* target() const noexcept {
+        return _target;
+    }
+    constexpr weight_pointer weight() const noexcept {
+        return _weight;
+    }
+
+    // Increment and decrement
+    public:
+    constexpr contact_iterator& operator++() noexcept {
+        return *this += 1;
+    }
+    constexpr contact_iterator operator++(int) noexcept {
+        contact_iterator self = *this;
+        ++*this;
+        return self;
+    }
+    constexpr contact_iterator& operator--() noexcept {
+        return *this -= 1;
+    }
+    constexpr contact_iterator operator--(int) noexcept {
+        contact_iterator self = *this;
+        --*this;
+        return self;
+    }
+    constexpr contact_iterator& operator+=(difference_type n) noexcept {
+        _target += n;
+        if constexpr (!std::is_void_v<weight_type>) {
+            _weight += n;
+        }
+        return *this;
+    }
+    constexpr contact_iterator& operator-=(difference_type n) noexcept {
+        return *this += -n;
+    }
+
+    // Arithmetic
+    public:
+    friend constexpr contact_iterator operator+(
+        contact_iterator it,
+        difference_type n
+    ) noexcept {
+        return it += n;
+    }
+    friend constexpr contact_iterator operator+(
+        difference_type n,
+        contact_iterator it
+    ) noexcept {
+        return it += n;
+    }
+    friend constexpr contact_iterator operator-(
+        contact_iterator it,
+        difference_type n
+    ) noexcept {
+        return it -= n;
+    }
+    friend constexpr difference_type operator-(
+        const contact_iterator& lhs,
+        const contact_iterator& rhs
+    ) noexcept {
+        return lhs._target - rhs._target;
+    }
+
+    // Comparison
+    public:
+    friend constexpr bool operator==(
+        const contact_iterator& lhs,
+        const contact_iterator& rhs
+    ) noexcept {
+        return lhs._target == rhs._target;
+    }
+    friend constexpr bool operator!=(
+        const contact_iterator& lhs,
+        const contact_iterator& rhs
+    ) noexcept {
+        return lhs._target != rhs._target;
+    }
+    friend constexpr bool operator<(
+        const contact_iterator& lhs,
+        const contact_iterator& rhs
+    ) noexcept {
+        return lhs._target < rhs._target;
+    }
+    friend constexpr bool operator>(
+        const contact_iterator& lhs,
+        const contact_iterator& rhs
+    ) noexcept {
+        return lhs._target > rhs._target;
+    }
+    friend constexpr bool operator<=(
+        const contact_iterator& lhs,
+        const contact_iterator& rhs
+    ) noexcept {
+        return lhs._target <= rhs._target;
+    }
+    friend constexpr bool operator>=(
+        const contact_iterator& lhs,
+        const contact_iterator& rhs
+    ) noexcept {
+        return lhs._target >= rhs._target;
+    }
+
+    // Implementation details
+    private:
+    const index_type* _target = nullptr;
+    weight_pointer _weight = nullptr;
+};
+
+// The pointer of a contact iterator: a proxy holding the edge it points to
+template <class Index, class Weight>
+class contact_iterator<Index, Weight>::pointer
+{
+    // Types
+    public:
+    using value_type = contact_edge<Index, Weight>;
+
+    // Lifecycle
+    public:
+    constexpr explicit pointer(const value_type& edge) noexcept
+    : _edge(edge) {
+    }
+
+    // Access
+    public:
+    constexpr const value_type* operator->() const noexcept {
+        return &_edge;
+    }
+
+    // Implementation details
+    private:
+    value_type _edge;
+};
+// ========================================================================== //
+
+
+
+// ============================= CONTACT GRAPH ============================== //
+// A multi-layer contact graph in compressed sparse row format, with one layer
+// per tag type of a pack, such as households, workplaces and schools: each
+// layer stores the offsets of the edges of every vertex, the 32-bit targets
+// of the edges, and optionally their weights in a separate column, so that a
+// sweep over the contacts of a layer streams a few contiguous arrays instead
+// of chasing one heap allocation per agent. Layers remember whether they were
+// assigned symmetrically, in which case the edges leaving a vertex are also
+// the edges reaching it: declaration
+template <
+    class Layers,
+    class Weight = void,
+    class Container = std::vector<std::byte>
+>
+class contact_graph;
+
+// A multi-layer contact graph: specialization
+template <class... Layers, class Weight, class Container>
+class contact_graph<type_pack<Layers...>, Weight, Container>
+{
+    // Types
+    public:
+    using layers_type = type_pack<Layers...>;
+    using weight_type = Weight;
+    using container_type = Container;
+    using index_type = std::uint32_t;
+    using offset_type = std::uint64_t;
+    using size_type = std::size_t;
+    using edge_type = contact_edge<index_type, weight_type>;
+    using iterator = contact_iterator<index_type, weight_type>;
+    using range_type = iterator_range<iterator>;
+    using offset_container_type = rebind_container_t<
+        container_type,
+        offset_type
+    >;
+    using index_container_type = rebind_container_t<
+        container_type,
+        index_type
+    >;
+    using weight_container_type = rebind_container_t<
+        container_type,
+        std::conditional_t<std::is_void_v<weight_type>, std::byte, weight_type>
+    >;
+
+    // Constants
+    public:
+    static constexpr bool weighted = !std::is_void_v<weight_type>;
+    static constexpr size_type layers = sizeof...(Layers);
+
+    // Helpers
+    private:
+    template <class Layer>
+    static constexpr bool _contains = (std::is_same_v<Layer, Layers> || ...);
+
+    // Checks
+    public:
+    static_assert(sizeof...(Layers) > 0, "contact graphs need layers");
+
+    // Lifecycle
+    public:
+    contact_graph() {
+        resize(0);
+    }
+    explicit contact_graph(size_type vertices) {
+        resize(vertices);
+    }
+
+    // Capacity
+    public:
+    bool empty() const noexcept {
+        return _vertices == 0;
+    }
+    size_type vertices() const noexcept {
+        return _vertices;
+    }
+    size_type edges() const noexcept {
+        size_type result = 0;
+        for (size_type layer = 0; layer < layers; ++layer) {
+            result += edges(layer);
+        }
+        return result;
+    }
+    size_type edges(size_type layer) const noexcept {
+        return _targets[layer].size();
+    }
+    template <class Layer>
+    size_type edges() const noexcept {
+        return edges(layer_index<Layer>());
+    }
+    void resize(size_type vertices) {
+        assert(vertices <= size_type(std::numeric_limits<index_type>::max()));
+        for (size_type layer = 0; layer < layers; ++layer) {
+            _offsets[layer].assign(vertices + 1, offset_type());
+            _targets[layer].clear();
+            _weights[layer].clear();
+            _symmetric[layer] = true;
+        }
+        _vertices = vertices;
+    }
+
+    // Layers
+    public:
+    template <class Layer>
+    static constexpr size_type layer_index() noexcept {
+        constexpr bool matches[] = {std::is_same_v<Layer, Layers>...};
+        static_assert(_contains<Layer>, "unknown layer");
+        size_type result = 0;
+        while (!matches[result]) {
+            ++result;
+        }
+        return result;
+    }
+    bool symmetric(size_type layer) const noexcept {
+        return _symmetric[layer];
+    }
+    template <class Layer>
+    bool symmetric() const noexcept {
+        return symmetric(layer_index<Layer>());
+    }
+
+    // Construction
+    public:
+    template <class Edges>
+    void assign(size_type layer, const Edges& edges, bool symmetric = false) {
+        offset_container_type& offsets = _offsets[layer];
+        index_container_type& targets = _targets[layer];
+        weight_container_type& weights = _weights[layer];
+        offsets.assign(_vertices + 1, offset_type());
+        for (const auto& edge: edges) {
+            assert(_source(edge) < _vertices && _target(edge) < _vertices);
+            ++offsets[_source(edge) + 1];
+            offsets[_target(edge) + 1] += symmetric;
+        }
+        for (size_type i = 0; i < _vertices; ++i) {
+            offsets[i + 1] += offsets[i];
+        }
+        targets.resize(offsets[_vertices]);
+        if constexpr (weighted) {
+            weights.resize(offsets[_vertices]);
+        }
+        for (const auto& edge: edges) {
+            _insert(layer, _source(edge), _target(edge), edge);
+            if (symmetric) {
+                _insert(layer, _target(edge), _source(edge), edge);
+            }
+        }
+        for (size_type i = _vertices; i > 0; --i) {
+            offsets[i] = offsets[i - 1];
+        }
+        offsets[0] = 0;
+        _symmetric[layer] = symmetric;
+    }
+    template <class Layer, class Edges>
+    void assign(const Edges& edges, bool symmetric = false) {
+        assign(layer_index<Layer>(), edges, symmetric);
+    }
+
+    // Renumbering
+    public:
+    template <class Order, class Rank>
+    void permute(const Order& order, const Rank& rank) {
+        for (size_type layer = 0; layer < layers; ++layer) {
+            const offset_container_type& offsets = _offsets[layer];
+            offset_container_type permuted_offsets(_vertices + 1);
+            index_container_type targets(_targets[layer].size());
+            weight_container_type weights(_weights[layer].size());
+            for (size_type i = 0; i < _vertices; ++i) {
+                const offset_type first = offsets[order[i]];
+                const offset_type last = offsets[order[i] + 1];
+                offset_type position = permuted_offsets[i];
+                for (offset_type j = first; j < last; ++j, ++position) {
+                    targets[position] = rank[_targets[layer][j]];
+                    if constexpr (weighted) {
+                        weights[position] = _weights[layer][j];
+                    }
+                }
+                permuted_offsets[i + 1] = position;
+            }
+            _offsets[layer] = std::move(permuted_offsets);
+            _targets[layer] = std::move(targets);
+            _weights[layer] = std::move(weights);
+        }
+    }
+
+    // Access
+    public:
+    size_type degree(size_type layer, index_type vertex) const noexcept {
+        const offset_container_type& offsets = _offsets[layer];
+        return offsets[vertex + 1] - offsets[vertex];
+    }
+    size_type degree(index_type vertex) const noexcept {
+        size_type result = 0;
+        for (size_type layer = 0; layer < layers; ++layer) {
+            result += degree(layer, vertex);
+        }
+        return result;
+    }
+    template <class Layer>
+    size_type degree(index_type vertex) const noexcept {
+        return degree(layer_index<Layer>(), vertex);
+    }
+    range_type neighbors(size_type layer, index_type vertex) const noexcept {
+        const offset_type first = _offsets[layer][vertex];
+        const offset_type last = _offsets[layer][vertex + 1];
+        return range_type(_iterator(layer, first), _iterator(layer, last));
+    }
+    template <class Layer>
+    range_type neighbors(index_type vertex) const noexcept {
+        return neighbors(layer_index<Layer>(), vertex);
+    }
+    const offset_container_type& offsets(size_type layer) const noexcept {
+        return _offsets[layer];
+    }
+    const index_container_type& targets(size_type layer) const noexcept {
+        return _targets[layer];
+    }
+    const weight_container_type& weights(size_type layer) const noexcept {
+        static_assert(weighted, "unweighted graphs have no weights");
+        return _weights[layer];
+    }
+    template <class Layer>
+    const offset_container_type& offsets() const noexcept {
+        return offsets(layer_index<Layer>());
+    }
+    template <class Layer>
+    const index_container_type& targets() const noexcept {
+        return targets(layer_index<Layer>());
+    }
+    template <class Layer>
+    const weight_container_type& weights() const noexcept {
+        return weights(layer_index<Layer>());
+    }
+
+    // Implementation details
+    private:
+    template <class Edge>
+    static index_type _source(const Edge& edge) noexcept {
+        using std::get;
+        return static_cast<index_type>(get<0>(edge));
+    }
+    template <class Edge>
+    static index_type _target(const Edge& edge) noexcept {
+        using std::get;
+        return static_cast<index_type>(get<1>(edge));
+    }
+    template <class Edge>
+    void _insert(
+        size_type layer,
+        index_type source,
+        index_type target,
+        const Edge& edge
+    ) {
+        const offset_type position = _offsets[layer][source]++;
+        _targets[layer][position] = target;
+        if constexpr (weighted) {
+            using std::get;
+            _weights[layer][position] = static_cast<weight_type>(get<2>(edge));
+        }
+    }
+    iterator _iterator(size_type layer, offset_type position) const noexcept {
+        if constexpr (weighted) {
+            return iterator(
+                std::data(_targets[layer]) + position,
+                std::data(_weights[layer]) + position
+            );
+        } else {
+            return iterator(std::data(_targets[layer]) + position);
+        }
+    }
+    std::array<offset_container_type, layers> _offsets;
+    std::array<index_container_type, layers> _targets;
+    std::array<weight_container_type, layers> _weights;
+    std::array<bool, layers> _symmetric = {};
+    size_type _vertices = 0;
+};
+// ========================================================================== //
+
+
+
+// ========================================================================== //
+} // namespace epidesim
+#endif // _GRAPHS_HPP_INCLUDED
+// ========================================================================== //
@@ -0,0 +1,275 @@
+// ================================ MOBILITY ================================ //
+// Project:         epidesim
+// Name:            mobility.hpp
+// Description:     Bucketing of agents by location for mobility schedules
+// Creator:         Vincent Reverdy
+// Contributor(s):  Vincent Reverdy [2020-]
+// License:         BSD 3-Clause License
+// ========================================================================== //
+#ifndef _MOBILITY_HPP_INCLUDED
+#define _MOBILITY_HPP_INCLUDED
+// ========================================================================== //
+
+
+
+// ============================== PREAMBLE ================================== //
+// C++ standard library
+#include <array>
+#include <vector>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <type_traits>
+// Project sources
+#include "pack.hpp"
+#include "bases.hpp"
+#include "parallel.hpp"
+// Third-party libraries
+// Miscellaneous
+namespace epidesim {
+// ========================================================================== //
+
+
+
+// ============================= LOCATION INDEX ============================= //
+// The index of the location of an agent for an activity named by a tag type,
+// such as its household, workplace or school, to be used as an attribute of
+// a schema so that memberships are stored as columns of the agent store
+template <class Tag>
+struct location_index {
+    using tag_type = Tag;
+    using value_type = std::uint32_t;
+    value_type value;
+    constexpr operator value_type() const noexcept {
+        return value;
+    }
+};
+// ========================================================================== //
+
+
+
+// ============================ LOCATION BUCKETS ============================ //
+// The agents of a population sorted by location, so that the agents of each
+// location span a contiguous range: the sort is the stable counting sort of
+// the executors, whose blocks are capped so that their counts never outgrow
+// the population or the locations, and keeps agents in increasing order
+// within each location. Location indices must be below the number of
+// locations. Columns can be gathered in bucket order, so that per-location
+// kernels stream contiguous values, and scattered back
+class location_buckets
+{
+    // Types
+    public:
+    using index_type = std::uint32_t;
+    using size_type = std::size_t;
+    using span_type = iterator_range<const index_type*>;
+
+    // Capacity
+    public:
+    bool empty() const noexcept {
+        return _agents.empty();
+    }
+    size_type size() const noexcept {
+        return _agents.size();
+    }
+    size_type locations() const noexcept {
+        return _offsets.empty() ? 0 : _offsets.size() - 1;
+    }
+
+    // Construction
+    public:
+    template <class Column>
+    void assign(const Column& column, size_type locations) {
+        sequential_executor executor;
+        assign(executor, column, locations);
+    }
+    template <class Executor, class Column>
+    void assign(Executor& executor, const Column& column, size_type locations) {
+        const auto key = [&column, locations](size_type i) noexcept {
+            const size_type location = static_cast<size_type>(column[i]);
+            assert(location < locations);
+            return location;
+        };
+        counting_sort(
+            executor,
+            std::size(column),
+            locations,
+            key,
+            _offsets,
+            _agents,
+            _counts
+        );
+    }
+
+    // Access
+    public:
+    size_type occupancy(size_type location) const noexcept {
+        return _offsets[location + 1] - _offsets[location];
+    }
+    span_type agents(size_type location) const noexcept {
+        const index_type* data = _agents.data();
+        return span_type(
+            data + _offsets[location],
+            data + _offsets[location + 1]
+        );
+    }
+    const std::vector<index_type>& agents() const noexcept {
+        return _agents;
+    }
+    const std::vector<size_type>& offsets() const noexcept {
+        return _offsets;
+    }
+
+    // Gather and scatter
+    public:
+    template <class Column, class Output>
+    void gather(const Column& column, Output& output) const {
+        sequential_executor executor;
+        gather(executor, column, output);
+    }
+    template <class Executor, class Column, class Output>
+    void gather(
+        Executor& executor,
+        const Column& column,
+        Output& output
+    ) const {
+        output.resize(_agents.size());
+        executor.parallel_for(0, _agents.size(), [&](size_type i) {
+            output[i] = column[_agents[i]];
+        });
+    }
+    template <class Input, class Column>
+    void scatter(const Input& input, Column& column) const {
+        sequential_executor executor;
+        scatter(executor, input, column);
+    }
+    template <class Executor, class Input, class Column>
+    void scatter(Executor& executor, const Input& input, Column& column) const {
+        executor.parallel_for(0, _agents.size(), [&](size_type i) {
+            column[_agents[i]] = input[i];
+        });
+    }
+
+    // Iteration
+    public:
+    template <class Function>
+    void for_each_location(Function&& function) const {
+        sequential_executor executor;
+        for_each_location(executor, function);
+    }
+    template <class Executor, class Function>
+    void for_each_location(Executor& executor, Function&& function) const {
+        executor.parallel_for(0, locations(), [&](size_type location) {
+            function(location, agents(location));
+        });
+    }
+
+    // Implementation details
+    private:
+    std::vector<size_type> _counts;
+    std::vector<size_type> _offsets;
+    std::vector<index_type> _agents;
+};
+// ========================================================================== //
+
+
+
+// ================================ MOBILITY ================================ //
+// The buckets of the locations visited by agents during their schedule, one
+// per activity tag of a pack: buckets are built from the location index
+// columns of a store the first time an activity is reached, and reused by the
+// following ticks as long as schedules repeat, until memberships change and
+// the buckets of an activity are invalidated: declaration
+template <class Activities>
+class mobility;
+
+// The buckets of the locations visited by agents: specialization
+template <class... Activities>
+class mobility<type_pack<Activities...>>
+{
+    // Types
+    public:
+    using activities_type = type_pack<Activities...>;
+    using buckets_type = location_buckets;
+    using size_type = std::size_t;
+
+    // Helpers
+    private:
+    template <class Activity>
+    static constexpr bool _contains
+    = (std::is_same_v<Activity, Activities> || ...);
+
+    // Checks
+    public:
+    static_assert(sizeof...(Activities) > 0, "mobility needs activities");
+
+    // Activities
+    public:
+    template <class Activity>
+    static constexpr size_type activity_index() noexcept {
+        constexpr bool matches[] = {std::is_same_v<Activity, Activities>...};
+        static_assert(_contains<Activity>, "unknown activity");
+        size_type result = 0;
+        while (!matches[result]) {
+            ++result;
+        }
+        return result;
+    }
+
+    // Buckets
+    public:
+    template <class Activity, class Store>
+    const buckets_type& buckets(const Store& store, size_type locations) {
+        sequential_executor executor;
+        return buckets<Activity>(executor, store, locations);
+    }
+    template <class Activity, class Executor, class Store>
+    const buckets_type& buckets(
+        Executor& executor,
+        const Store& store,
+        size_type locations
+    ) {
+        constexpr size_type index = activity_index<Activity>();
+        if (!_valid[index]) {
+            _buckets[index].assign(
+                executor,
+                store.template column<location_index<Activity>>(),
+                locations
+            );
+            _valid[index] = true;
+            ++_rebuilds;
+        }
+        return _buckets[index];
+    }
+    template <class Activity>
+    bool valid() const noexcept {
+        return _valid[activity_index<Activity>()];
+    }
+    template <class Activity>
+    void invalidate() noexcept {
+        _valid[activity_index<Activity>()] = false;
+    }
+    void invalidate() noexcept {
+        _valid.fill(false);
+    }
+    size_type rebuilds() const noexcept {
+        return _rebuilds;
+    }
+
+    // Implementation details
+    private:
+    std::array<buckets_type, sizeof...(Activities)> _buckets;
+    std::array<bool, sizeof...(Activities)> _valid = {};
+    size_type _rebuilds = 0;
+};
+// ========================================================================== //
+
+
+
+// ========================================================================== //
+} // namespace epidesim
+#endif // _MOBILITY_HPP_INCLUDED
+// ========================================================================== //
@@ -0,0 +1,269 @@
+// ================================= MODELS ================================= //
+// Project:         epidesim
+// Name:            models.hpp
+// Description:     Compile-time specification of compartmental models
+// Creator:         Vincent Reverdy
+// Contributor(s):  Vincent Reverdy [2020-]
+// License:         BSD 3-Clause License
+// ========================================================================== //
+#ifndef _MODELS_HPP_INCLUDED
+#define _MODELS_HPP_INCLUDED
+// ========================================================================== //
+
+
+
+// ============================== PREAMBLE ================================== //
+// C++ standard library
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+#include <type_traits>
+// Project sources
+#include "pack.hpp"
+#include "wrappers.hpp"
+#include "constants.hpp"
+// Third-party libraries
+// Miscellaneous
+namespace epidesim {
+// ========================================================================== //
+
+
+
+// =============================== TRANSITION =============================== //
+// A transition from a compartment to another one, at a rate per unit of time
+// given as a floating point constant, such as the type of a scientific_v
+template <class From, class To, class Rate>
+struct transition {
+    using from_type = From;
+    using to_type = To;
+    using rate_type = std::remove_cv_t<Rate>;
+    using value_type = typename rate_type::value_type;
+    static constexpr value_type rate = rate_type::value;
+    static_assert(!std::is_same_v<From, To>, "transitions change compartments");
+    static_assert(rate >= value_type(0), "rates should be non-negative");
+};
+
+// A list of transitions, as a pack of types
+template <class... Transitions>
+struct transitions: type_pack<Transitions...> {
+    using base = typename transitions::type_pack;
+};
+// ========================================================================== //
+
+
+
+// ========================== OUTGOING TRANSITIONS ========================== //
+// Lists the transitions leaving a compartment, and counts them: declaration
+template <class Compartment, class Transitions>
+struct outgoing_transitions;
+
+// Lists the transitions leaving a compartment, and counts them: list of
+// transitions specialization
+template <class Compartment, class... Transitions>
+struct outgoing_transitions<Compartment, transitions<Transitions...>> {
+    using type = typename pack_to<pack_concat_t<std::conditional_t<
+        std::is_same_v<typename Transitions::from_type, Compartment>,
+        type_pack<Transitions>,
+        type_pack<>
+    >...>>::template temploid<transitions>;
+    static constexpr std::size_t value = pack_size_v<type>;
+};
+
+// Alias template
+template <class Compartment, class Transitions>
+using outgoing_transitions_t
+= typename outgoing_transitions<Compartment, Transitions>::type;
+
+// Variable template
+template <class Compartment, class Transitions>
+inline constexpr std::size_t outgoing_transitions_v
+= outgoing_transitions<Compartment, Transitions>::value;
+// ========================================================================== //
+
+
+
+// ================================== MODEL ================================= //
+// A compartmental model declared at compile time from a pack of compartment
+// types and a list of transitions: the transitions leaving each compartment
+// are gathered by applying a trait on the pack of compartments, and the
+// probabilities of leaving a compartment during a step, which are constants
+// of the model, are folded into a transition kernel unrolled over the
+// compartments so that agents change compartment without any runtime table,
+// switch or virtual call: declaration
+template <class Compartments, class Transitions>
+class model;
+
+// A compartmental model: specialization
+template <class... Compartments, class... Transitions>
+class model<type_pack<Compartments...>, transitions<Transitions...>>
+{
+    // Types
+    public:
+    using compartments_type = type_pack<Compartments...>;
+    using transitions_type = transitions<Transitions...>;
+    using size_type = std::size_t;
+    using code_type = std::uint8_t;
+    using unit_step = floating_point_constant<double, 1, 10, 0>;
+    using outgoing_type = decltype(compartments_type::template apply_t<
+        type_trait<outgoing_transitions>,
+        transitions_type
+    >());
+    using degrees_type = decltype(compartments_type::template apply_v<
+        type_trait<outgoing_transitions>,
+        transitions_type
+    >());
+
+    // Helpers
+    private:
+    template <std::size_t... Indices>
+    static constexpr nttp_pack<code_type(Indices)...> _states(
+        std::index_sequence<Indices...>
+    ) noexcept;
+    template <class Compartment>
+    static constexpr bool _contains
+    = (std::is_same_v<Compartment, Compartments> || ...);
+
+    // Types
+    public:
+    using states_type = decltype(_states(
+        std::index_sequence_for<Compartments...>()
+    ));
+
+    // Checks
+    public:
+    static_assert(sizeof...(Compartments) > 0, "models need compartments");
+    static_assert(sizeof...(Compartments) <= 256, "too many compartments");
+    static_assert(
+        (_contains<typename Transitions::from_type> && ...) &&
+        (_contains<typename Transitions::to_type> && ...),
+        "transitions should connect compartments of the model"
+    );
+
+    // Properties
+    public:
+    static constexpr size_type compartment_count() noexcept {
+        return sizeof...(Compartments);
+    }
+    static constexpr size_type transition_count() noexcept {
+        return sizeof...(Transitions);
+    }
+    static constexpr std::array<size_type, sizeof...(Compartments)> degrees()
+    noexcept {
+        return pack_values_v<degrees_type>;
+    }
+    template <class Compartment>
+    static constexpr code_type code() noexcept {
+        constexpr bool matches[] = {
+            std::is_same_v<Compartment, Compartments>...
+        };
+        static_assert(_contains<Compartment>, "unknown compartment");
+        code_type result = 0;
+        while (!matches[result]) {
+            ++result;
+        }
+        return result;
+    }
+
+    // Kernel
+    public:
+    template <class Step = unit_step>
+    static constexpr code_type next(code_type code, double uniform) noexcept {
+        return _next<Step>(
+            code,
+            uniform,
+            std::index_sequence_for<Compartments...>()
+        );
+    }
+    template <class Step = unit_step, class Column, class Uniforms>
+    static size_type step(Column& column, const Uniforms& uniforms) {
+        const size_type size = std::size(column);
+        size_type result = 0;
+        for (size_type i = 0; i < size; ++i) {
+            const code_type current = column[i];
+            const code_type following = next<Step>(current, uniforms[i]);
+            column[i] = following;
+            result += following != current;
+        }
+        return result;
+    }
+
+    // Implementation details
+    private:
+    static constexpr double _exp(double x) noexcept {
+        size_type halvings = 0;
+        for (; x > 0.5 || x < -0.5; x /= 2) {
+            ++halvings;
+        }
+        double term = 1;
+        double result = 1;
+        for (size_type n = 1; n < 24; ++n) {
+            term *= x / static_cast<double>(n);
+            result += term;
+        }
+        for (; halvings > 0; --halvings) {
+            result *= result;
+        }
+        return result;
+    }
+    template <class Step, std::size_t... Indices>
+    static constexpr code_type _next(
+        code_type code,
+        double uniform,
+        std::index_sequence<Indices...>
+    ) noexcept {
+        code_type result = code;
+        ((code == Indices ? void(result = _leave<Step, Indices>(
+            uniform,
+            typename pack_element_t<
+                outgoing_type,
+                Indices
+            >::wrapper_type::type()
+        )) : void()), ...);
+        return result;
+    }
+    template <class Step, class... Outgoing>
+    static constexpr std::array<double, sizeof...(Outgoing)> _thresholds()
+    noexcept {
+        constexpr double step = static_cast<double>(Step::value);
+        constexpr double rates[] = {static_cast<double>(Outgoing::rate)...};
+        constexpr double total = (static_cast<double>(Outgoing::rate) + ...);
+        constexpr double leave = total > 0 ? 1 - _exp(-total * step) : 0;
+        std::array<double, sizeof...(Outgoing)> result = {};
+        double partial = 0;
+        for (size_type i = 0; i < sizeof...(Outgoing); ++i) {
+            partial += rates[i];
+            result[i] = total > 0 ? leave * partial / total : 0;
+        }
+        return result;
+    }
+    template <class Step, std::size_t Index, class... Outgoing>
+    static constexpr code_type _leave(
+        double uniform,
+        transitions<Outgoing...>
+    ) noexcept {
+        if constexpr (sizeof...(Outgoing) == 0) {
+            return Index;
+        } else {
+            constexpr std::array<double, sizeof...(Outgoing)> cumulative
+            = _thresholds<Step, Outgoing...>();
+            constexpr code_type targets[] = {
+                code<typename Outgoing::to_type>()...
+            };
+            code_type result = Index;
+            for (size_type i = sizeof...(Outgoing); i > 0; --i) {
+                result = uniform < cumulative[i - 1] ? targets[i - 1] : result;
+            }
+            return result;
+        }
+    }
+};
+// ========================================================================== //
+
+
+
+// ========================================================================== //
+} // namespace epidesim
+#endif // _MODELS_HPP_INCLUDED
+// ========================================================================== //
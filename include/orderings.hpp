@@ -0,0 +1,246 @@
+// =============================== ORDERINGS ================================ //
+// Project:         epidesim
+// Name:            orderings.hpp
+// Description:     Locality-improving renumberings of agents
+// Creator:         Vincent Reverdy
+// Contributor(s):  Vincent Reverdy [2020-]
+// License:         BSD 3-Clause License
+// ========================================================================== //
+#ifndef _ORDERINGS_HPP_INCLUDED
+#define _ORDERINGS_HPP_INCLUDED
+// ========================================================================== //
+
+
+
+// ============================== PREAMBLE ================================== //
+// C++ standard library
+#include <vector>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <type_traits>
+// Project sources
+// Third-party libraries
+// Miscellaneous
+namespace epidesim {
+// ========================================================================== //
+
+
+
+// ============================== PERMUTATIONS ============================== //
+// Orders list the former index of the agent at each new position, and ranks
+// list the new position of each former index
+using ordering = std::vector<std::uint32_t>;
+
+// Computes the ranks of an order
+template <class Order>
+ordering invert_ordering(const Order& order) {
+    const std::size_t size = std::size(order);
+    ordering result(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        result[order[i]] = static_cast<std::uint32_t>(i);
+    }
+    return result;
+}
+
+// Gathers the elements of a column in a new order, including packed columns
+// accessed through proxies
+template <class Column, class Order>
+void permute_column(Column& column, const Order& order) {
+    Column result = column;
+    const std::size_t size = std::size(order);
+    for (std::size_t i = 0; i < size; ++i) {
+        result[i] = column[order[i]];
+    }
+    column = std::move(result);
+}
+
+// Gathers all the columns of a structure of arrays in a new order
+template <class Store, class Order>
+void permute_columns(Store& store, const Order& order) {
+    store.for_each_column([&order](auto& column) {
+        permute_column(column, order);
+    });
+}
+
+// Renumbers the agents referred to by the leaves of a tree, whose indices are
+// accessed through a projection of the values of the leaves
+template <class Tree, class Rank, class Projection>
+void renumber_leaves(Tree& tree, const Rank& rank, Projection&& projection) {
+    using index_type = typename Tree::index_type;
+    const index_type size = static_cast<index_type>(tree.size());
+    for (index_type i = 0; i < size; ++i) {
+        if (tree.is_leaf(i)) {
+            auto& index = projection(tree[i]);
+            index = rank[index];
+        }
+    }
+}
+// ========================================================================== //
+
+
+
+// ============================ HOUSEHOLD MAJOR ============================= //
+// Orders agents by household, households being dense indices, by a stable
+// counting sort so that agents of the same household stay in their former
+// relative order and become contiguous
+template <class Households>
+ordering household_major_ordering(const Households& households) {
+    const std::size_t size = std::size(households);
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < size; ++i) {
+        count = std::max(count, static_cast<std::size_t>(households[i]) + 1);
+    }
+    std::vector<std::size_t> offsets(count + 1);
+    for (std::size_t i = 0; i < size; ++i) {
+        ++offsets[static_cast<std::size_t>(households[i]) + 1];
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+        offsets[i + 1] += offsets[i];
+    }
+    ordering result(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        const std::size_t household = static_cast<std::size_t>(households[i]);
+        result[offsets[household]++] = static_cast<std::uint32_t>(i);
+    }
+    return result;
+}
+// ========================================================================== //
+
+
+
+// ========================= REVERSE CUTHILL MCKEE ========================== //
+// Orders the vertices of a contact graph by reverse Cuthill-McKee over all
+// its layers: each connected component is traversed breadth first from one
+// of its vertices of lowest degree, visiting neighbors by increasing degree,
+// and the resulting order is reversed, which narrows the band of the
+// adjacency matrix so that neighbors get close indices
+template <class Graph>
+ordering reverse_cuthill_mckee_ordering(const Graph& graph) {
+    using index_type = typename Graph::index_type;
+    const std::size_t size = graph.vertices();
+    std::vector<std::size_t> degrees(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        degrees[i] = graph.degree(static_cast<index_type>(i));
+    }
+    const auto by_degree = [&degrees](index_type lhs, index_type rhs) {
+        return degrees[lhs] < degrees[rhs]
+        || (degrees[lhs] == degrees[rhs] && lhs < rhs);
+    };
+    ordering seeds(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        seeds[i] = static_cast<index_type>(i);
+    }
+    std::sort(seeds.begin(), seeds.end(), by_degree);
+    std::vector<char> visited(size, false);
+    ordering result;
+    result.reserve(size);
+    for (const index_type seed: seeds) {
+        if (visited[seed]) {
+            continue;
+        }
+        visited[seed] = true;
+        result.push_back(seed);
+        std::size_t head = result.size() - 1;
+        for (; head < result.size(); ++head) {
+            const std::size_t first = result.size();
+            for (std::size_t layer = 0; layer < Graph::layers; ++layer) {
+                for (const auto& edge: graph.neighbors(layer, result[head])) {
+                    if (!visited[edge.target]) {
+                        visited[edge.target] = true;
+                        result.push_back(edge.target);
+                    }
+                }
+            }
+            std::sort(result.begin() + first, result.end(), by_degree);
+        }
+    }
+    std::reverse(result.begin(), result.end());
+    return result;
+}
+// ========================================================================== //
+
+
+
+// ============================== HILBERT CURVE ============================= //
+// Computes the distance along a Hilbert curve of a cell of a square grid of
+// side two to the power of the given number of bits, which is at most 32 so
+// that the side is computed on 64 bits and the distance fits in 64 bits
+constexpr std::uint64_t hilbert_index(
+    std::uint32_t x,
+    std::uint32_t y,
+    unsigned int bits
+) noexcept {
+    assert(bits <= 32);
+    const std::uint64_t side = std::uint64_t(1) << bits;
+    std::uint64_t result = 0;
+    for (std::uint64_t s = side / 2; s > 0; s /= 2) {
+        const std::uint64_t rx = (x & s) > 0;
+        const std::uint64_t ry = (y & s) > 0;
+        result += s * s * ((3 * rx) ^ ry);
+        if (ry == 0) {
+            if (rx == 1) {
+                x = static_cast<std::uint32_t>(side - 1 - x);
+                y = static_cast<std::uint32_t>(side - 1 - y);
+            }
+            const std::uint32_t z = x;
+            x = y;
+            y = z;
+        }
+    }
+    return result;
+}
+
+// Orders agents along a Hilbert curve over their home coordinates, quantized
+// on a grid spanning their bounding box, so that agents living close to each
+// other get close indices
+template <class Abscissas, class Ordinates>
+ordering hilbert_ordering(
+    const Abscissas& x,
+    const Ordinates& y,
+    unsigned int bits = 16
+) {
+    assert(bits <= 32);
+    const std::size_t size = std::size(x);
+    ordering result(size);
+    if (size == 0) {
+        return result;
+    }
+    double bounds[4] = {double(x[0]), double(x[0]), double(y[0]), double(y[0])};
+    for (std::size_t i = 0; i < size; ++i) {
+        bounds[0] = std::min(bounds[0], double(x[i]));
+        bounds[1] = std::max(bounds[1], double(x[i]));
+        bounds[2] = std::min(bounds[2], double(y[i]));
+        bounds[3] = std::max(bounds[3], double(y[i]));
+    }
+    const double cells = double((std::uint64_t(1) << bits) - 1);
+    const double extent = std::max(
+        bounds[1] - bounds[0],
+        bounds[3] - bounds[2]
+    );
+    const double scale = extent > 0 ? cells / extent : 0;
+    std::vector<std::pair<std::uint64_t, std::uint32_t>> keys(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        keys[i] = {hilbert_index(
+            static_cast<std::uint32_t>((double(x[i]) - bounds[0]) * scale),
+            static_cast<std::uint32_t>((double(y[i]) - bounds[2]) * scale),
+            bits
+        ), static_cast<std::uint32_t>(i)};
+    }
+    std::sort(keys.begin(), keys.end());
+    for (std::size_t i = 0; i < size; ++i) {
+        result[i] = keys[i].second;
+    }
+    return result;
+}
+// ========================================================================== //
+
+
+
+// ========================================================================== //
+} // namespace epidesim
+#endif // _ORDERINGS_HPP_INCLUDED
+// ========================================================================== //
@@ -14,6 +14,7 @@
 
 // ============================== PREAMBLE ================================== //
 // C++ standard library
+#include <array>
 #include <utility>
 #include <type_traits>
 // Project sources
@@ -92,14 +93,18 @@ struct pack_base: Elements... {
         typename decltype(Elements::template apply<Trait, Args...>())::type...
     >;
     template <class Trait, class... Args>
-    using apply_result_v = std::conditional_t<
-        std::is_same_v<std::common_type_t<
+    using apply_common_type = typename std::conditional_t<
+        std::is_same_v<Trait, Trait>,
+        std::common_type<
             decltype(Elements::template apply<Trait, Args...>().value)...
-        >, bool>,
+        >,
+        std::common_type<>
+    >::type;
+    template <class Trait, class... Args>
+    using apply_result_v = std::conditional_t<
+        std::is_same_v<apply_common_type<Trait, Args...>, bool>,
         bool_pack<std::conditional_t<
-            std::is_same_v<std::common_type_t<
-                decltype(Elements::template apply<Trait, Args...>().value)...
-            >, bool>,
+            std::is_same_v<apply_common_type<Trait, Args...>, bool>,
             decltype(Elements::template apply<Trait, Args...>()),
             std::false_type
         >::value...>,
@@ -577,6 +582,39 @@ inline constexpr std::size_t pack_index_v = pack_index<Element>::value;
 
 
 
+// =============================== PACK VALUES ============================== //
+// Lists the values of a pack of values in an array: declaration
+template <class T, class = void, class = void>
+struct pack_values;
+
+// Lists the values of a pack of values in an array: pack specialization
+template <class Pack, std::size_t... Indices>
+struct pack_values<
+    Pack,
+    std::index_sequence<Indices...>,
+    if_pack_t<Pack>
+> {
+    using value_type = std::common_type_t<
+        decltype(pack_element_t<Pack, Indices>::wrapper_type::value)...
+    >;
+    using type = std::array<value_type, sizeof...(Indices)>;
+    static constexpr type value = {{
+        pack_element_t<Pack, Indices>::wrapper_type::value...
+    }};
+};
+
+// Lists the values of a pack of values in an array: indexing
+template <class Pack>
+struct pack_values<Pack, void, if_pack_t<Pack>>
+: pack_values<Pack, std::make_index_sequence<pack_size_v<Pack>>> {};
+
+// Variable template
+template <class Pack>
+inline constexpr auto pack_values_v = pack_values<Pack>::value;
+// ========================================================================== //
+
+
+
 // ================================ PACK GET ================================ //
 // Returns a reference to the element specified by the provided index argument
 template <class Pack, std::size_t Index>
@@ -711,6 +749,240 @@ struct swap_template_arguments<Lhs<L, Ls...>, Rhs<R, Rs...>> {
 
 
 
+// =============================== PACK CONCAT ============================== //
+// Concatenates type packs: declaration
+template <class... Packs>
+struct pack_concat;
+
+// Joins the type packs of a list by groups of sixteen in a single pass, the
+// joined groups being concatenated in turn by the next pass, so that each
+// type goes through a logarithmic number of intermediate packs instead of a
+// linear one with a fold, and the depth of instantiation is divided by
+// sixteen, without ever instantiating the packs nor their types: declaration
+template <class Joined, class... Packs>
+struct pack_concat_round;
+
+// Joins the type packs of a list by groups of sixteen: end of the list
+template <class... Joined>
+struct pack_concat_round<type_pack<Joined...>>
+: pack_concat<Joined...> {};
+
+// Joins the type packs of a list by groups of sixteen: last pack of the list
+template <class... Joined, class... Types>
+struct pack_concat_round<type_pack<Joined...>, type_pack<Types...>>
+: pack_concat<Joined..., type_pack<Types...>> {};
+
+// Joins the type packs of a list by groups of sixteen: first two packs of
+// fewer than sixteen, merged with each other
+template <class... Joined, class... Lhs, class... Rhs, class... Packs>
+struct pack_concat_round<
+    type_pack<Joined...>,
+    type_pack<Lhs...>,
+    type_pack<Rhs...>,
+    Packs...
+>: pack_concat_round<type_pack<Joined...>, type_pack<Lhs..., Rhs...>, Packs...>
+{};
+
+// Joins the type packs of a list by groups of sixteen: group of sixteen packs
+template <
+    class... Joined,
+    class... T0,
+    class... T1,
+    class... T2,
+    class... T3,
+    class... T4,
+    class... T5,
+    class... T6,
+    class... T7,
+    class... T8,
+    class... T9,
+    class... TA,
+    class... TB,
+    class... TC,
+    class... TD,
+    class... TE,
+    class... TF,
+    class... Packs
+>
+struct pack_concat_round<
+    type_pack<Joined...>,
+    type_pack<T0...>,
+    type_pack<T1...>,
+    type_pack<T2...>,
+    type_pack<T3...>,
+    type_pack<T4...>,
+    type_pack<T5...>,
+    type_pack<T6...>,
+    type_pack<T7...>,
+    type_pack<T8...>,
+    type_pack<T9...>,
+    type_pack<TA...>,
+    type_pack<TB...>,
+    type_pack<TC...>,
+    type_pack<TD...>,
+    type_pack<TE...>,
+    type_pack<TF...>,
+    Packs...
+>: pack_concat_round<type_pack<Joined..., type_pack<
+        T0..., T1..., T2..., T3..., T4..., T5..., T6..., T7..., T8..., T9...,
+        TA..., TB..., TC..., TD..., TE..., TF...
+>>, Packs...> {};
+
+// Concatenates type packs: several packs
+template <class... Packs>
+struct pack_concat: pack_concat_round<type_pack<>, Packs...> {};
+
+// Concatenates type packs: no pack
+template <>
+struct pack_concat<> {
+    using type = type_pack<>;
+};
+
+// Concatenates type packs: single type pack
+template <class... Types>
+struct pack_concat<type_pack<Types...>> {
+    using type = type_pack<Types...>;
+};
+
+// Alias template
+template <class... Packs>
+using pack_concat_t = typename pack_concat<Packs...>::type;
+// ========================================================================== //
+
+
+
+// =============================== PACK FILTER ============================== //
+// Keeps the types of a type pack satisfying a wrapped trait: declaration
+template <class Pack, class Trait, class... Args>
+struct pack_filter;
+
+// Keeps the types of a type pack satisfying a wrapped trait: type pack
+// specialization, each type becoming a pack of zero or one type, the packs
+// being concatenated by groups of sixteen
+template <class... Types, class Trait, class... Args>
+struct pack_filter<type_pack<Types...>, Trait, Args...> {
+    using type = pack_concat_t<std::conditional_t<
+        static_cast<bool>(Trait::template value<Types, Args...>),
+        type_pack<Types>,
+        type_pack<>
+    >...>;
+};
+
+// Alias template
+template <class Pack, class Trait, class... Args>
+using pack_filter_t = typename pack_filter<Pack, Trait, Args...>::type;
+// ========================================================================== //
+
+
+
+// ============================= PACK TRANSFORM ============================= //
+// Applies a wrapped trait to each type of a type pack: declaration
+template <class Pack, class Trait, class... Args>
+struct pack_transform;
+
+// Applies a wrapped trait to each type of a type pack: type pack
+// specialization
+template <class... Types, class Trait, class... Args>
+struct pack_transform<type_pack<Types...>, Trait, Args...> {
+    using type = type_pack<typename Trait::template type<Types, Args...>...>;
+};
+
+// Alias template
+template <class Pack, class Trait, class... Args>
+using pack_transform_t = typename pack_transform<Pack, Trait, Args...>::type;
+// ========================================================================== //
+
+
+
+// ============================== PACK INDEX OF ============================= //
+// Finds the index of the first occurrence of a type among types, or the number
+// of types if it does not occur
+template <class T, class... Types>
+constexpr std::size_t first_index_of() noexcept {
+    constexpr bool matches[] = {std::is_same_v<T, Types>..., true};
+    std::size_t result = 0;
+    while (!matches[result]) {
+        ++result;
+    }
+    return result;
+}
+
+// Finds the index of the first occurrence of a type in a type pack:
+// declaration
+template <class Pack, class T>
+struct pack_index_of;
+
+// Finds the index of the first occurrence of a type in a type pack: type pack
+// specialization
+template <class... Types, class T>
+struct pack_index_of<type_pack<Types...>, T>
+: index_constant<first_index_of<T, Types...>()> {};
+
+// Variable template
+template <class Pack, class T>
+inline constexpr std::size_t pack_index_of_v = pack_index_of<Pack, T>::value;
+// ========================================================================== //
+
+
+
+// =============================== PACK UNIQUE ============================== //
+// Carries a type through the fold removing duplicates: the insertion of the
+// type in the set of the types already met is a hidden friend of a nested
+// tag, so that argument-dependent lookup neither instantiates the type nor
+// the set, and the set derives from a distinct nested member without friends,
+// so that the lookup does not grow with the set
+template <class T>
+struct pack_unique_element {
+    struct member {};
+    struct tag {
+        template <class Set>
+        friend constexpr typename Set::template insert<T> operator+(
+            Set,
+            tag
+        ) noexcept {
+            return typename Set::template insert<T>{};
+        }
+    };
+};
+
+// The set of the types already met by the fold removing duplicates, whose
+// nested tag derives from the members of its types, so that the membership
+// of a type is a single check of base class instead of a comparison per type
+template <class... Types>
+struct pack_unique_set {
+    struct tag: pack_unique_element<Types>::member... {
+        using type = type_pack<Types...>;
+        template <class T>
+        using insert = typename std::conditional_t<
+            std::is_base_of_v<typename pack_unique_element<T>::member, tag>,
+            pack_unique_set,
+            pack_unique_set<Types..., T>
+        >::tag;
+    };
+};
+
+// Removes the duplicated types of a type pack, keeping their first occurrence:
+// declaration
+template <class Pack>
+struct pack_unique;
+
+// Removes the duplicated types of a type pack: type pack specialization, the
+// types being inserted in a set through a single fold expression
+template <class... Types>
+struct pack_unique<type_pack<Types...>> {
+    using type = typename decltype((
+        typename pack_unique_set<>::tag{} + ...
+        + typename pack_unique_element<Types>::tag{}
+    ))::type;
+};
+
+// Alias template
+template <class Pack>
+using pack_unique_t = typename pack_unique<Pack>::type;
+// ========================================================================== //
+
+
+
 // ========================================================================== //
 } // namespace epidesim
 #endif // _PACK_HPP_INCLUDED
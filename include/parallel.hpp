@@ -0,0 +1,453 @@
+// ================================ PARALLEL ================================ //
+// Project:         epidesim
+// Name:            parallel.hpp
+// Description:     Work-stealing thread pool and parallel loops
+// Creator:         Vincent Reverdy
+// Contributor(s):  Vincent Reverdy [2020-]
+// License:         BSD 3-Clause License
+// ========================================================================== //
+#ifndef _PARALLEL_HPP_INCLUDED
+#define _PARALLEL_HPP_INCLUDED
+// ========================================================================== //
+
+
+
+// ============================== PREAMBLE ================================== //
+// C++ standard library
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include <exception>
+#include <type_traits>
+#include <condition_variable>
+// Project sources
+// Third-party libraries
+// Miscellaneous
+namespace epidesim {
+// ========================================================================== //
+
+
+
+// ========================== THREAD POOL COUNTERS ========================== //
+// Counters of the scheduling activity of a thread pool: the number of chunks
+// executed, of chunks ranges successfully stolen from another thread, of
+// steal attempts finding nothing or losing a race, and of times a thread ran
+// out of work while a loop was still being executed by others
+struct thread_pool_counters {
+    std::size_t chunks = 0;
+    std::size_t steals = 0;
+    std::size_t failed_steals = 0;
+    std::size_t idle = 0;
+};
+// ========================================================================== //
+
+
+
+// =============================== THREAD POOL ============================== //
+// A pool of worker threads executing loops over index spaces by work
+// stealing: the index space of a loop is cut into chunks, each thread starts
+// with a contiguous range of chunks, and threads running out of chunks steal
+// the upper half of the remaining range of another thread, so that imbalanced
+// iterations are redistributed without a shared queue. The calling thread
+// takes part in the execution, and loops issued from inside a task are
+// executed serially by the thread issuing them. Each thread of the pool has
+// a worker index below the size of the pool, threads outside of the pool
+// such as the calling one being worker zero, so that loops can keep state
+// per worker without synchronization
+class thread_pool
+{
+    // Types
+    public:
+    using size_type = std::size_t;
+    using counters_type = thread_pool_counters;
+
+    // Constants
+    public:
+    static constexpr size_type default_chunk = 1024;
+
+    // Lifecycle
+    public:
+    thread_pool(): thread_pool(default_concurrency()) {
+    }
+    explicit thread_pool(size_type concurrency)
+    : _slots(new _slot[std::max(concurrency, size_type(1))]) {
+        concurrency = std::max(concurrency, size_type(1));
+        _threads.reserve(concurrency - 1);
+        for (size_type i = 1; i < concurrency; ++i) {
+            _threads.emplace_back([this, i]{work(i);});
+        }
+    }
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+    ~thread_pool() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stopping = true;
+        }
+        _wakeup.notify_all();
+        for (std::thread& thread: _threads) {
+            thread.join();
+        }
+    }
+
+    // Capacity
+    public:
+    size_type size() const noexcept {
+        return _threads.size() + 1;
+    }
+    static size_type default_concurrency() noexcept {
+        return std::max(std::thread::hardware_concurrency(), 1U);
+    }
+    size_type worker() const noexcept {
+        const std::pair<const thread_pool*, size_type>& worker = _worker();
+        return worker.first == this ? worker.second : 0;
+    }
+
+    // Counters
+    public:
+    counters_type counters() const noexcept {
+        counters_type result;
+        for (size_type i = 0; i < size(); ++i) {
+            result.chunks += _slots[i].chunks.load(std::memory_order_relaxed);
+            result.steals += _slots[i].steals.load(std::memory_order_relaxed);
+            result.failed_steals += _slots[i].failed_steals.load(
+                std::memory_order_relaxed
+            );
+            result.idle += _slots[i].idle.load(std::memory_order_relaxed);
+        }
+        return result;
+    }
+    void reset_counters() noexcept {
+        for (size_type i = 0; i < size(); ++i) {
+            _slots[i].chunks.store(0, std::memory_order_relaxed);
+            _slots[i].steals.store(0, std::memory_order_relaxed);
+            _slots[i].failed_steals.store(0, std::memory_order_relaxed);
+            _slots[i].idle.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    // Execution
+    public:
+    template <class Function>
+    void parallel_for(size_type first, size_type last, Function&& function) {
+        parallel_for(first, last, default_chunk, function);
+    }
+    template <class Function>
+    void parallel_for(
+        size_type first,
+        size_type last,
+        size_type chunk,
+        Function&& function
+    ) {
+        using function_type = std::remove_reference_t<Function>;
+        chunk = std::max(chunk, size_type(1));
+        if (first >= last) {
+            return;
+        } else if (last - first <= chunk || _threads.empty() || _inside()) {
+            for (; first < last; ++first) {
+                function(first);
+            }
+            return;
+        }
+        std::lock_guard<std::mutex> submission(_submission);
+        chunk = std::max(chunk, size_type((last - first + _mask - 1) / _mask));
+        const size_type chunks = (last - first + chunk - 1) / chunk;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _invoke = [](void* context, size_type begin, size_type end) {
+                function_type& f = *static_cast<function_type*>(context);
+                for (; begin < end; ++begin) {
+                    f(begin);
+                }
+            };
+            _context = const_cast<void*>(
+                static_cast<const volatile void*>(std::addressof(function))
+            );
+            for (size_type i = 0; i < size(); ++i) {
+                _slots[i].range.store(_pack(
+                    i * chunks / size(),
+                    (i + 1) * chunks / size()
+                ), std::memory_order_relaxed);
+            }
+            _first = first;
+            _last = last;
+            _chunk = chunk;
+            _active = _threads.size();
+            _exception = nullptr;
+            ++_generation;
+        }
+        _wakeup.notify_all();
+        execute(0);
+        std::unique_lock<std::mutex> lock(_mutex);
+        _done.wait(lock, [this]{return _active == 0;});
+        if (_exception) {
+            std::rethrow_exception(std::exchange(_exception, nullptr));
+        }
+    }
+
+    // Implementation details
+    private:
+    struct alignas(64) _slot {
+        std::atomic<std::uint64_t> range = 0;
+        std::atomic<size_type> chunks = 0;
+        std::atomic<size_type> steals = 0;
+        std::atomic<size_type> failed_steals = 0;
+        std::atomic<size_type> idle = 0;
+    };
+    static constexpr std::uint64_t _mask = 0xFFFFFFFF;
+    static constexpr std::uint64_t _pack(
+        std::uint64_t begin,
+        std::uint64_t end
+    ) noexcept {
+        return (begin << 32) | end;
+    }
+    static bool& _inside() noexcept {
+        thread_local bool inside = false;
+        return inside;
+    }
+    static std::pair<const thread_pool*, size_type>& _worker() noexcept {
+        thread_local std::pair<const thread_pool*, size_type> worker = {};
+        return worker;
+    }
+    bool pop(size_type self, std::uint64_t& chunk) noexcept {
+        std::atomic<std::uint64_t>& range = _slots[self].range;
+        std::uint64_t current = range.load(std::memory_order_acquire);
+        while ((current >> 32) < (current & _mask)) {
+            if (range.compare_exchange_weak(
+                current,
+                current + (std::uint64_t(1) << 32),
+                std::memory_order_acq_rel
+            )) {
+                chunk = current >> 32;
+                return true;
+            }
+        }
+        return false;
+    }
+    bool steal(size_type self, std::uint64_t& chunk) noexcept {
+        for (size_type offset = 1; offset < size(); ++offset) {
+            _slot& victim = _slots[(self + offset) % size()];
+            std::uint64_t current = victim.range.load(
+                std::memory_order_acquire
+            );
+            const std::uint64_t begin = current >> 32;
+            const std::uint64_t end = current & _mask;
+            if (begin >= end) {
+                continue;
+            }
+            const std::uint64_t middle = end - (end - begin + 1) / 2;
+            if (victim.range.compare_exchange_strong(
+                current,
+                _pack(begin, middle),
+                std::memory_order_acq_rel
+            )) {
+                chunk = middle;
+                _slots[self].range.store(
+                    _pack(middle + 1, end),
+                    std::memory_order_release
+                );
+                _slots[self].steals.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+            _slots[self].failed_steals.fetch_add(1, std::memory_order_relaxed);
+        }
+        return false;
+    }
+    void execute(size_type self) noexcept {
+        _inside() = true;
+        _running.fetch_add(1, std::memory_order_acq_rel);
+        std::uint64_t chunk = 0;
+        while (pop(self, chunk) || steal(self, chunk)) {
+            const size_type begin = _first + chunk * _chunk;
+            try {
+                _invoke(_context, begin, std::min(begin + _chunk, _last));
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (!_exception) {
+                    _exception = std::current_exception();
+                }
+                for (size_type i = 0; i < size(); ++i) {
+                    _slots[i].range.store(0, std::memory_order_release);
+                }
+            }
+            _slots[self].chunks.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (_running.fetch_sub(1, std::memory_order_acq_rel) > 1) {
+            _slots[self].idle.fetch_add(1, std::memory_order_relaxed);
+        }
+        _inside() = false;
+    }
+    void work(size_type self) {
+        _worker() = {this, self};
+        size_type generation = 0;
+        std::unique_lock<std::mutex> lock(_mutex);
+        while (true) {
+            _wakeup.wait(lock, [&]{
+                return _stopping || _generation != generation;
+            });
+            if (_stopping) {
+                return;
+            }
+            generation = _generation;
+            lock.unlock();
+            execute(self);
+            lock.lock();
+            if (--_active == 0) {
+                _done.notify_one();
+            }
+        }
+    }
+    std::unique_ptr<_slot[]> _slots;
+    std::vector<std::thread> _threads;
+    std::mutex _submission;
+    std::mutex _mutex;
+    std::condition_variable _wakeup;
+    std::condition_variable _done;
+    void (*_invoke)(void*, size_type, size_type) = nullptr;
+    void* _context = nullptr;
+    size_type _first = 0;
+    size_type _last = 0;
+    size_type _chunk = default_chunk;
+    size_type _active = 0;
+    std::atomic<size_type> _running = 0;
+    size_type _generation = 0;
+    bool _stopping = false;
+    std::exception_ptr _exception;
+};
+// ========================================================================== //
+
+
+
+// =========================== SEQUENTIAL EXECUTOR ========================== //
+// An executor running loops serially on the calling thread, for the serial
+// overloads of algorithms written against the interface of the thread pool
+class sequential_executor
+{
+    // Types
+    public:
+    using size_type = std::size_t;
+
+    // Constants
+    public:
+    static constexpr size_type default_chunk = thread_pool::default_chunk;
+
+    // Capacity
+    public:
+    static constexpr size_type size() noexcept {
+        return 1;
+    }
+    static constexpr size_type worker() noexcept {
+        return 0;
+    }
+
+    // Execution
+    public:
+    template <class Function>
+    void parallel_for(size_type first, size_type last, Function&& function) {
+        parallel_for(first, last, default_chunk, function);
+    }
+    template <class Function>
+    void parallel_for(
+        size_type first,
+        size_type last,
+        size_type,
+        Function&& function
+    ) {
+        for (; first < last; ++first) {
+            function(first);
+        }
+    }
+};
+// ========================================================================== //
+
+
+
+// ============================== COUNTING SORT ============================= //
+// Sorts the indices of a range by keys below a given count with a stable
+// counting sort executed by an executor: the range is cut into blocks which
+// count their keys in their own rows of a table, the number of blocks being
+// capped so that the table holds no more entries than the range or the keys,
+// the offsets of the keys are computed by a parallel prefix over segments of
+// keys, and each block scatters its indices through its own row, so that
+// indices keep their relative order within each key
+template <class Executor, class Key, class Index>
+void counting_sort(
+    Executor& executor,
+    std::size_t size,
+    std::size_t keys,
+    Key&& key,
+    std::vector<std::size_t>& offsets,
+    std::vector<Index>& indices,
+    std::vector<std::size_t>& counts
+) {
+    using size_type = std::size_t;
+    constexpr size_type minimum_block = 4096;
+    const size_type blocks = std::max(std::min(
+        executor.size(),
+        size / std::max(keys, minimum_block)
+    ), size_type(1));
+    const size_type segments = std::max(
+        std::min(executor.size(), keys),
+        size_type(1)
+    );
+    const auto first = [=](size_type block) noexcept {
+        return block * size / blocks;
+    };
+    const auto begin = [=](size_type segment) noexcept {
+        return segment * keys / segments;
+    };
+    counts.assign(blocks * keys + segments + 1, 0);
+    size_type* totals = counts.data() + blocks * keys;
+    executor.parallel_for(0, blocks, 1, [&](size_type block) {
+        size_type* row = counts.data() + block * keys;
+        for (size_type i = first(block); i < first(block + 1); ++i) {
+            ++row[static_cast<size_type>(key(i))];
+        }
+    });
+    executor.parallel_for(0, segments, 1, [&](size_type segment) {
+        size_type total = 0;
+        for (size_type k = begin(segment); k < begin(segment + 1); ++k) {
+            for (size_type block = 0; block < blocks; ++block) {
+                total += counts[block * keys + k];
+            }
+        }
+        totals[segment + 1] = total;
+    });
+    for (size_type segment = 0; segment < segments; ++segment) {
+        totals[segment + 1] += totals[segment];
+    }
+    offsets.resize(keys + 1);
+    executor.parallel_for(0, segments, 1, [&](size_type segment) {
+        size_type position = totals[segment];
+        for (size_type k = begin(segment); k < begin(segment + 1); ++k) {
+            offsets[k] = position;
+            for (size_type block = 0; block < blocks; ++block) {
+                size_type& count = counts[block * keys + k];
+                position += std::exchange(count, position);
+            }
+        }
+    });
+    offsets[keys] = size;
+    indices.resize(size);
+    executor.parallel_for(0, blocks, 1, [&](size_type block) {
+        size_type* positions = counts.data() + block * keys;
+        for (size_type i = first(block); i < first(block + 1); ++i) {
+            const size_type k = static_cast<size_type>(key(i));
+            indices[positions[k]++] = static_cast<Index>(i);
+        }
+    });
+}
+// ========================================================================== //
+
+
+
+// ========================================================================== //
+} // namespace epidesim
+#endif // _PARALLEL_HPP_INCLUDED
+// ========================================================================== //
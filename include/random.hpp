@@ -0,0 +1,329 @@
+// ================================= RANDOM ================================= //
+// Project:         epidesim
+// Name:            random.hpp
+// Description:     Counter-based random number generation keyed by agents
+// Creator:         Vincent Reverdy
+// Contributor(s):  Vincent Reverdy [2020-]
+// License:         BSD 3-Clause License
+// ========================================================================== //
+#ifndef _RANDOM_HPP_INCLUDED
+#define _RANDOM_HPP_INCLUDED
+// ========================================================================== //
+
+
+
+// ============================== PREAMBLE ================================== //
+// C++ standard library
+#include <array>
+#include <limits>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <algorithm>
+#include <type_traits>
+// Project sources
+// Third-party libraries
+// Miscellaneous
+namespace epidesim {
+// ========================================================================== //
+
+
+
+// ================================ PHILOX 4X32 ============================= //
+// The Philox4x32-10 bijection of Salmon et al. mapping a 128-bit counter and a
+// 64-bit key to 128 random bits with ten rounds of multiplications
+struct philox4x32 {
+    using word_type = std::uint32_t;
+    using counter_type = std::array<word_type, 4>;
+    using key_type = std::array<word_type, 2>;
+    static constexpr std::size_t rounds = 10;
+    static constexpr counter_type generate(
+        counter_type counter,
+        key_type key
+    ) noexcept {
+        for (std::size_t round = 0; round < rounds; ++round) {
+            const std::uint64_t first = std::uint64_t(0xD2511F53) * counter[0];
+            const std::uint64_t second = std::uint64_t(0xCD9E8D57) * counter[2];
+            counter = {
+                static_cast<word_type>(second >> 32) ^ counter[1] ^ key[0],
+                static_cast<word_type>(second),
+                static_cast<word_type>(first >> 32) ^ counter[3] ^ key[1],
+                static_cast<word_type>(first)
+            };
+            key[0] += 0x9E3779B9;
+            key[1] += 0xBB67AE85;
+        }
+        return counter;
+    }
+};
+// ========================================================================== //
+
+
+
+// =============================== THREEFRY 4X32 ============================ //
+// The Threefry4x32-20 bijection of Salmon et al. mapping a 128-bit counter and
+// a 64-bit key, zero-extended to the 128 bits of the cipher, to 128 random
+// bits with twenty rounds of additions, rotations and exclusive ors
+struct threefry4x32 {
+    using word_type = std::uint32_t;
+    using counter_type = std::array<word_type, 4>;
+    using key_type = std::array<word_type, 2>;
+    static constexpr std::size_t rounds = 20;
+    static constexpr counter_type generate(
+        counter_type counter,
+        key_type key
+    ) noexcept {
+        constexpr unsigned int rotations[8][2] = {
+            {10, 26}, {11, 21}, {13, 27}, {23, 5},
+            {6, 20}, {17, 11}, {25, 10}, {18, 20}
+        };
+        const word_type schedule[5] = {
+            key[0], key[1], 0, 0, 0x1BD11BDA ^ key[0] ^ key[1]
+        };
+        for (std::size_t i = 0; i < 4; ++i) {
+            counter[i] += schedule[i];
+        }
+        for (std::size_t round = 0; round < rounds; ++round) {
+            const unsigned int* rotation = rotations[round % 8];
+            const std::size_t left = round % 2 ? 3 : 1;
+            const std::size_t right = round % 2 ? 1 : 3;
+            counter[0] += counter[left];
+            counter[left] = _rotate(counter[left], rotation[0]) ^ counter[0];
+            counter[2] += counter[right];
+            counter[right] = _rotate(counter[right], rotation[1]) ^ counter[2];
+            if (round % 4 == 3) {
+                const std::size_t injection = round / 4 + 1;
+                for (std::size_t i = 0; i < 4; ++i) {
+                    counter[i] += schedule[(injection + i) % 5];
+                }
+                counter[3] += static_cast<word_type>(injection);
+            }
+        }
+        return counter;
+    }
+    private:
+    static constexpr word_type _rotate(word_type x, unsigned int n) noexcept {
+        return (x << n) | (x >> (32 - n));
+    }
+};
+// ========================================================================== //
+
+
+
+// ============================ COUNTER BASED RNG =========================== //
+// A counter-based generator producing the draws of a stream for a tick of a
+// simulation: the draws of an agent are a pure function of the seed, the
+// tick, the stream, the agent index and the draw index, so that results are
+// bitwise reproducible regardless of the number of threads and of the order
+// in which agents are processed. Each evaluation of the bijection yields the
+// words of four consecutive agents, and the batch functions fill whole
+// columns or tiles with loops free of dependencies between iterations.
+// Uniforms are centered on the top bits of the words that the mantissa can
+// hold along with the half offset, so that they stay in the open interval
+// (0, 1) once rounded, whatever the floating point type
+template <class Bijection = philox4x32>
+class counter_based_rng
+{
+    // Types
+    public:
+    using bijection_type = Bijection;
+    using word_type = typename bijection_type::word_type;
+    using counter_type = typename bijection_type::counter_type;
+    using key_type = typename bijection_type::key_type;
+    using index_type = std::uint32_t;
+    using size_type = std::size_t;
+
+    // Constants
+    public:
+    static constexpr size_type block = std::tuple_size_v<counter_type>;
+
+    // Lifecycle
+    public:
+    constexpr counter_based_rng() noexcept = default;
+    constexpr counter_based_rng(
+        std::uint64_t seed,
+        index_type tick = 0,
+        index_type stream = 0
+    ) noexcept
+    : _key{static_cast<word_type>(seed), static_cast<word_type>(seed >> 32)}
+    , _tick(tick)
+    , _stream(stream) {
+    }
+
+    // Keys
+    public:
+    constexpr counter_based_rng at(index_type tick) const noexcept {
+        counter_based_rng result = *this;
+        result._tick = tick;
+        return result;
+    }
+    constexpr counter_based_rng with(index_type stream) const noexcept {
+        counter_based_rng result = *this;
+        result._stream = stream;
+        return result;
+    }
+    constexpr std::uint64_t seed() const noexcept {
+        return (std::uint64_t(_key[1]) << 32) | _key[0];
+    }
+    constexpr index_type tick() const noexcept {
+        return _tick;
+    }
+    constexpr index_type stream() const noexcept {
+        return _stream;
+    }
+
+    // Draws
+    public:
+    constexpr counter_type block_bits(
+        index_type group,
+        index_type draw = 0
+    ) const noexcept {
+        return bijection_type::generate({group, _tick, _stream, draw}, _key);
+    }
+    constexpr word_type bits(
+        index_type agent,
+        index_type draw = 0
+    ) const noexcept {
+        return block_bits(agent / block, draw)[agent % block];
+    }
+    template <class Real = double>
+    constexpr Real uniform(index_type agent, index_type draw = 0) const {
+        return to_uniform<Real>(bits(agent, draw));
+    }
+
+    // Batches
+    public:
+    void fill_bits(
+        index_type first,
+        word_type* output,
+        size_type count,
+        index_type draw = 0
+    ) const noexcept {
+        size_type i = 0;
+        for (; i < count && (first + i) % block; ++i) {
+            output[i] = bits(first + i, draw);
+        }
+        const size_type whole = i + (count - i) / block * block;
+        for (; i < whole; i += block) {
+            const counter_type words = block_bits((first + i) / block, draw);
+            for (size_type lane = 0; lane < block; ++lane) {
+                output[i + lane] = words[lane];
+            }
+        }
+        for (; i < count; ++i) {
+            output[i] = bits(first + i, draw);
+        }
+    }
+    template <class Real>
+    void fill_uniform(
+        index_type first,
+        Real* output,
+        size_type count,
+        index_type draw = 0
+    ) const noexcept {
+        constexpr size_type width = 64;
+        word_type words[width] = {};
+        for (size_type i = 0; i < count; i += width) {
+            const size_type size = std::min(width, count - i);
+            fill_bits(first + static_cast<index_type>(i), words, size, draw);
+            for (size_type lane = 0; lane < size; ++lane) {
+                output[i + lane] = to_uniform<Real>(words[lane]);
+            }
+        }
+    }
+    template <class Range>
+    void fill_bits(
+        index_type first,
+        Range&& range,
+        index_type draw = 0
+    ) const noexcept {
+        fill_bits(first, std::data(range), std::size(range), draw);
+    }
+    template <class Range>
+    void fill_uniform(
+        index_type first,
+        Range&& range,
+        index_type draw = 0
+    ) const noexcept {
+        fill_uniform(first, std::data(range), std::size(range), draw);
+    }
+
+    // Conversion
+    public:
+    template <class Real>
+    static constexpr Real to_uniform(word_type word) noexcept {
+        static_assert(std::is_floating_point_v<Real>, "not a floating point");
+        constexpr int word_bits = std::numeric_limits<word_type>::digits;
+        constexpr int bits = std::min(
+            word_bits,
+            std::numeric_limits<Real>::digits - 1
+        );
+        constexpr Real scale = Real(1) / Real(std::uint64_t(1) << bits);
+        return (static_cast<Real>(word >> (word_bits - bits)) + Real(0.5))
+        * scale;
+    }
+
+    // Implementation details
+    private:
+    key_type _key = {};
+    index_type _tick = 0;
+    index_type _stream = 0;
+};
+// ========================================================================== //
+
+
+
+// ============================= AGENT ENGINE ============================== //
+// A uniform random bit generator walking through the draws of a single agent
+// of a counter-based generator, for use with the standard distributions
+template <class Bijection = philox4x32>
+class agent_engine
+{
+    // Types
+    public:
+    using rng_type = counter_based_rng<Bijection>;
+    using result_type = typename rng_type::word_type;
+    using index_type = typename rng_type::index_type;
+
+    // Lifecycle
+    public:
+    constexpr agent_engine(
+        const rng_type& rng,
+        index_type agent,
+        index_type draw = 0
+    ) noexcept
+    : _rng(rng), _agent(agent), _draw(draw) {
+    }
+
+    // Generation
+    public:
+    static constexpr result_type min() noexcept {
+        return std::numeric_limits<result_type>::min();
+    }
+    static constexpr result_type max() noexcept {
+        return std::numeric_limits<result_type>::max();
+    }
+    constexpr result_type operator()() noexcept {
+        return _rng.bits(_agent, _draw++);
+    }
+    constexpr void discard(unsigned long long count) noexcept {
+        _draw += static_cast<index_type>(count);
+    }
+    constexpr index_type draws() const noexcept {
+        return _draw;
+    }
+
+    // Implementation details
+    private:
+    rng_type _rng;
+    index_type _agent;
+    index_type _draw;
+};
+// ========================================================================== //
+
+
+
+// ========================================================================== //
+} // namespace epidesim
+#endif // _RANDOM_HPP_INCLUDED
+// ========================================================================== //
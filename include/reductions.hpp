@@ -0,0 +1,591 @@
+// =============================== REDUCTIONS =============================== //
+// Project:         epidesim
+// Name:            reductions.hpp
+// Description:     Vectorized reductions over columns of agent attributes
+// Creator:         Vincent Reverdy
+// Contributor(s):  Vincent Reverdy [2020-]
+// License:         BSD 3-Clause License
+// ========================================================================== //
+#ifndef _REDUCTIONS_HPP_INCLUDED
+#define _REDUCTIONS_HPP_INCLUDED
+// ========================================================================== //
+
+
+
+// ============================== PREAMBLE ================================== //
+// C++ standard library
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <algorithm>
+#include <type_traits>
+// Project sources
+#include "pack.hpp"
+#include "columns.hpp"
+// Third-party libraries
+// Miscellaneous
+#if defined(__AVX512F__) || defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+namespace epidesim {
+// ========================================================================== //
+
+
+
+// =========================== REDUCTION KERNELS ============================ //
+// Kernels of the column reductions: the widest instruction set enabled at
+// compile time among AVX-512, AVX2 and SSE2 is used, and the scalar loops
+// handle the remainders as well as the targets without vector extensions
+struct reduction_kernels {
+    // Counts the bytes equal to a value
+    static std::size_t count(
+        const unsigned char* data,
+        std::size_t size,
+        unsigned char value
+    ) noexcept {
+        std::size_t result = 0;
+        std::size_t i = 0;
+#if defined(__AVX512BW__)
+        const __m512i pattern = _mm512_set1_epi8(static_cast<char>(value));
+        for (; i + 64 <= size; i += 64) {
+            const __m512i block = _mm512_loadu_si512(data + i);
+            result += popcount(_mm512_cmpeq_epi8_mask(block, pattern));
+        }
+#elif defined(__AVX2__)
+        const __m256i pattern = _mm256_set1_epi8(static_cast<char>(value));
+        for (; i + 32 <= size; i += 32) {
+            const __m256i block = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i*>(data + i)
+            );
+            result += popcount(static_cast<std::uint32_t>(
+                _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, pattern))
+            ));
+        }
+#elif defined(__SSE2__)
+        const __m128i pattern = _mm_set1_epi8(static_cast<char>(value));
+        for (; i + 16 <= size; i += 16) {
+            const __m128i block = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(data + i)
+            );
+            result += popcount(static_cast<std::uint32_t>(
+                _mm_movemask_epi8(_mm_cmpeq_epi8(block, pattern))
+            ));
+        }
+#endif
+        for (; i < size; ++i) {
+            result += data[i] == value;
+        }
+        return result;
+    }
+
+    // Counts the bytes equal to each of several values in a single pass: each
+    // block is compared once per value and the lanes equal to it are counted
+    // in byte accumulators, which are summed before they can overflow
+    template <std::size_t States>
+    static void histogram(
+        const unsigned char* data,
+        std::size_t size,
+        const std::array<unsigned char, States>& values,
+        std::array<std::size_t, States>& result
+    ) noexcept {
+        std::size_t i = 0;
+#if defined(__AVX512BW__)
+        __m512i patterns[States];
+        for (std::size_t s = 0; s < States; ++s) {
+            patterns[s] = _mm512_set1_epi8(static_cast<char>(values[s]));
+        }
+        for (; i + 64 <= size; i += 64) {
+            const __m512i block = _mm512_loadu_si512(data + i);
+            for (std::size_t s = 0; s < States; ++s) {
+                result[s] += popcount(
+                    _mm512_cmpeq_epi8_mask(block, patterns[s])
+                );
+            }
+        }
+#elif defined(__AVX2__)
+        __m256i patterns[States];
+        __m256i counters[States];
+        for (std::size_t s = 0; s < States; ++s) {
+            patterns[s] = _mm256_set1_epi8(static_cast<char>(values[s]));
+        }
+        while (i + 32 <= size) {
+            const std::size_t blocks = std::min<std::size_t>(
+                (size - i) / 32,
+                255
+            );
+            for (std::size_t s = 0; s < States; ++s) {
+                counters[s] = _mm256_setzero_si256();
+            }
+            for (std::size_t b = 0; b < blocks; ++b, i += 32) {
+                const __m256i block = _mm256_loadu_si256(
+                    reinterpret_cast<const __m256i*>(data + i)
+                );
+                for (std::size_t s = 0; s < States; ++s) {
+                    counters[s] = _mm256_sub_epi8(
+                        counters[s],
+                        _mm256_cmpeq_epi8(block, patterns[s])
+                    );
+                }
+            }
+            for (std::size_t s = 0; s < States; ++s) {
+                alignas(32) std::uint64_t lanes[4];
+                _mm256_store_si256(
+                    reinterpret_cast<__m256i*>(lanes),
+                    _mm256_sad_epu8(counters[s], _mm256_setzero_si256())
+                );
+                result[s] += (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+            }
+        }
+#elif defined(__SSE2__)
+        __m128i patterns[States];
+        __m128i counters[States];
+        for (std::size_t s = 0; s < States; ++s) {
+            patterns[s] = _mm_set1_epi8(static_cast<char>(values[s]));
+        }
+        while (i + 16 <= size) {
+            const std::size_t blocks = std::min<std::size_t>(
+                (size - i) / 16,
+                255
+            );
+            for (std::size_t s = 0; s < States; ++s) {
+                counters[s] = _mm_setzero_si128();
+            }
+            for (std::size_t b = 0; b < blocks; ++b, i += 16) {
+                const __m128i block = _mm_loadu_si128(
+                    reinterpret_cast<const __m128i*>(data + i)
+                );
+                for (std::size_t s = 0; s < States; ++s) {
+                    counters[s] = _mm_sub_epi8(
+                        counters[s],
+                        _mm_cmpeq_epi8(block, patterns[s])
+                    );
+                }
+            }
+            for (std::size_t s = 0; s < States; ++s) {
+                alignas(16) std::uint64_t lanes[2];
+                _mm_store_si128(
+                    reinterpret_cast<__m128i*>(lanes),
+                    _mm_sad_epu8(counters[s], _mm_setzero_si128())
+                );
+                result[s] += lanes[0] + lanes[1];
+            }
+        }
+#endif
+        for (; i < size; ++i) {
+            for (std::size_t s = 0; s < States; ++s) {
+                result[s] += data[i] == values[s];
+            }
+        }
+    }
+
+    // Sums double precision values
+    static double sum(const double* data, std::size_t size) noexcept {
+        double result = 0;
+        std::size_t i = 0;
+#if defined(__AVX512F__)
+        __m512d lhs = _mm512_setzero_pd();
+        __m512d rhs = _mm512_setzero_pd();
+        for (; i + 16 <= size; i += 16) {
+            lhs = _mm512_add_pd(lhs, _mm512_loadu_pd(data + i));
+            rhs = _mm512_add_pd(rhs, _mm512_loadu_pd(data + i + 8));
+        }
+        alignas(64) double lanes[8];
+        _mm512_store_pd(lanes, _mm512_add_pd(lhs, rhs));
+        for (std::size_t lane = 0; lane < 8; ++lane) {
+            result += lanes[lane];
+        }
+#elif defined(__AVX2__)
+        __m256d lhs = _mm256_setzero_pd();
+        __m256d rhs = _mm256_setzero_pd();
+        for (; i + 8 <= size; i += 8) {
+            lhs = _mm256_add_pd(lhs, _mm256_loadu_pd(data + i));
+            rhs = _mm256_add_pd(rhs, _mm256_loadu_pd(data + i + 4));
+        }
+        alignas(32) double lanes[4];
+        _mm256_store_pd(lanes, _mm256_add_pd(lhs, rhs));
+        result = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#elif defined(__SSE2__)
+        __m128d lhs = _mm_setzero_pd();
+        __m128d rhs = _mm_setzero_pd();
+        for (; i + 4 <= size; i += 4) {
+            lhs = _mm_add_pd(lhs, _mm_loadu_pd(data + i));
+            rhs = _mm_add_pd(rhs, _mm_loadu_pd(data + i + 2));
+        }
+        alignas(16) double lanes[2];
+        _mm_store_pd(lanes, _mm_add_pd(lhs, rhs));
+        result = lanes[0] + lanes[1];
+#endif
+        for (; i < size; ++i) {
+            result += data[i];
+        }
+        return result;
+    }
+
+    // Sums single precision values
+    static float sum(const float* data, std::size_t size) noexcept {
+        float result = 0;
+        std::size_t i = 0;
+#if defined(__AVX512F__)
+        __m512 lhs = _mm512_setzero_ps();
+        __m512 rhs = _mm512_setzero_ps();
+        for (; i + 32 <= size; i += 32) {
+            lhs = _mm512_add_ps(lhs, _mm512_loadu_ps(data + i));
+            rhs = _mm512_add_ps(rhs, _mm512_loadu_ps(data + i + 16));
+        }
+        alignas(64) float lanes[16];
+        _mm512_store_ps(lanes, _mm512_add_ps(lhs, rhs));
+        for (std::size_t lane = 0; lane < 16; ++lane) {
+            result += lanes[lane];
+        }
+#elif defined(__AVX2__)
+        __m256 lhs = _mm256_setzero_ps();
+        __m256 rhs = _mm256_setzero_ps();
+        for (; i + 16 <= size; i += 16) {
+            lhs = _mm256_add_ps(lhs, _mm256_loadu_ps(data + i));
+            rhs = _mm256_add_ps(rhs, _mm256_loadu_ps(data + i + 8));
+        }
+        alignas(32) float lanes[8];
+        _mm256_store_ps(lanes, _mm256_add_ps(lhs, rhs));
+        for (std::size_t lane = 0; lane < 8; ++lane) {
+            result += lanes[lane];
+        }
+#elif defined(__SSE2__)
+        __m128 lhs = _mm_setzero_ps();
+        __m128 rhs = _mm_setzero_ps();
+        for (; i + 8 <= size; i += 8) {
+            lhs = _mm_add_ps(lhs, _mm_loadu_ps(data + i));
+            rhs = _mm_add_ps(rhs, _mm_loadu_ps(data + i + 4));
+        }
+        alignas(16) float lanes[4];
+        _mm_store_ps(lanes, _mm_add_ps(lhs, rhs));
+        result = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#endif
+        for (; i < size; ++i) {
+            result += data[i];
+        }
+        return result;
+    }
+
+    // Finds the minimum or maximum of double precision values without NaNs
+    template <bool Maximum>
+    static double extremum(const double* data, std::size_t size) noexcept {
+        double result = data[0];
+        std::size_t i = 0;
+#if defined(__AVX2__)
+        __m256d accumulator = _mm256_set1_pd(result);
+        for (; i + 4 <= size; i += 4) {
+            const __m256d block = _mm256_loadu_pd(data + i);
+            accumulator = Maximum
+            ? _mm256_max_pd(accumulator, block)
+            : _mm256_min_pd(accumulator, block);
+        }
+        alignas(32) double lanes[4];
+        _mm256_store_pd(lanes, accumulator);
+        for (std::size_t lane = 0; lane < 4; ++lane) {
+            result = Maximum
+            ? std::max(result, lanes[lane])
+            : std::min(result, lanes[lane]);
+        }
+#elif defined(__SSE2__)
+        __m128d accumulator = _mm_set1_pd(result);
+        for (; i + 2 <= size; i += 2) {
+            const __m128d block = _mm_loadu_pd(data + i);
+            accumulator = Maximum
+            ? _mm_max_pd(accumulator, block)
+            : _mm_min_pd(accumulator, block);
+        }
+        alignas(16) double lanes[2];
+        _mm_store_pd(lanes, accumulator);
+        for (std::size_t lane = 0; lane < 2; ++lane) {
+            result = Maximum
+            ? std::max(result, lanes[lane])
+            : std::min(result, lanes[lane]);
+        }
+#endif
+        for (; i < size; ++i) {
+            result = Maximum
+            ? std::max(result, data[i])
+            : std::min(result, data[i]);
+        }
+        return result;
+    }
+
+    // Finds the minimum or maximum of single precision values without NaNs
+    template <bool Maximum>
+    static float extremum(const float* data, std::size_t size) noexcept {
+        float result = data[0];
+        std::size_t i = 0;
+#if defined(__AVX2__)
+        __m256 accumulator = _mm256_set1_ps(result);
+        for (; i + 8 <= size; i += 8) {
+            const __m256 block = _mm256_loadu_ps(data + i);
+            accumulator = Maximum
+            ? _mm256_max_ps(accumulator, block)
+            : _mm256_min_ps(accumulator, block);
+        }
+        alignas(32) float lanes[8];
+        _mm256_store_ps(lanes, accumulator);
+        for (std::size_t lane = 0; lane < 8; ++lane) {
+            result = Maximum
+            ? std::max(result, lanes[lane])
+            : std::min(result, lanes[lane]);
+        }
+#elif defined(__SSE2__)
+        __m128 accumulator = _mm_set1_ps(result);
+        for (; i + 4 <= size; i += 4) {
+            const __m128 block = _mm_loadu_ps(data + i);
+            accumulator = Maximum
+            ? _mm_max_ps(accumulator, block)
+            : _mm_min_ps(accumulator, block);
+        }
+        alignas(16) float lanes[4];
+        _mm_store_ps(lanes, accumulator);
+        for (std::size_t lane = 0; lane < 4; ++lane) {
+            result = Maximum
+            ? std::max(result, lanes[lane])
+            : std::min(result, lanes[lane]);
+        }
+#endif
+        for (; i < size; ++i) {
+            result = Maximum
+            ? std::max(result, data[i])
+            : std::min(result, data[i]);
+        }
+        return result;
+    }
+
+    // Checks whether values of a type can be handled as raw bytes
+    template <class T>
+    static constexpr bool is_byte_v = sizeof(T) == 1
+    && std::is_trivially_copyable_v<T>
+    && !std::is_floating_point_v<T>;
+
+    // Converts a value to its byte representation
+    template <class T>
+    static unsigned char byte(const T& value) noexcept {
+        unsigned char result = 0;
+        std::memcpy(&result, &value, 1);
+        return result;
+    }
+};
+// ========================================================================== //
+
+
+
+// =============================== COLUMN SUM =============================== //
+// Selects the type of the sum of values: the requested result type when it is
+// provided, and otherwise the type of the values for floating point values, so
+// that the vectorized kernels apply, and 64-bit integers of the same
+// signedness for integral values, so that narrow integers do not overflow
+template <class T, class Result = void, class = void>
+struct column_sum_result {
+    using type = Result;
+};
+
+// Selects the type of the sum of values: non-integral values
+template <class T>
+struct column_sum_result<T, void, std::enable_if_t<!std::is_integral_v<T>>> {
+    using type = T;
+};
+
+// Selects the type of the sum of values: integral values
+template <class T>
+struct column_sum_result<T, void, std::enable_if_t<std::is_integral_v<T>>> {
+    using type = std::conditional_t<
+        std::is_signed_v<T>,
+        std::int64_t,
+        std::uint64_t
+    >;
+};
+
+// Alias template
+template <class T, class Result = void>
+using column_sum_result_t = typename column_sum_result<T, Result>::type;
+
+// Sums the values of a column
+template <class Result = void, class T>
+column_sum_result_t<T, Result> column_sum(
+    const T* data,
+    std::size_t size
+) noexcept {
+    using result_type = column_sum_result_t<T, Result>;
+    if constexpr (
+        std::is_same_v<result_type, T> &&
+        (std::is_same_v<T, double> || std::is_same_v<T, float>)
+    ) {
+        return reduction_kernels::sum(data, size);
+    } else {
+        result_type result[4] = {};
+        std::size_t i = 0;
+        for (; i + 4 <= size; i += 4) {
+            result[0] += static_cast<result_type>(data[i]);
+            result[1] += static_cast<result_type>(data[i + 1]);
+            result[2] += static_cast<result_type>(data[i + 2]);
+            result[3] += static_cast<result_type>(data[i + 3]);
+        }
+        for (; i < size; ++i) {
+            result[0] += static_cast<result_type>(data[i]);
+        }
+        return (result[0] + result[1]) + (result[2] + result[3]);
+    }
+}
+
+// Sums the values of a contiguous range
+template <class Result = void, class Range>
+auto column_sum(const Range& range) noexcept {
+    return column_sum<Result>(std::data(range), std::size(range));
+}
+
+// Sums the values of a compartment column
+template <class Result = void, class States, class Container>
+column_sum_result_t<
+    typename compartment_column<States, Container>::value_type,
+    Result
+> column_sum(const compartment_column<States, Container>& column) noexcept {
+    using value_type = typename compartment_column<
+        States,
+        Container
+    >::value_type;
+    return column.template sum<column_sum_result_t<value_type, Result>>();
+}
+// ========================================================================== //
+
+
+
+// ============================== COLUMN COUNT ============================== //
+// Counts the values of a column equal to the provided one
+template <class T>
+std::size_t column_count(
+    const T* data,
+    std::size_t size,
+    const std::remove_cv_t<T>& value
+) noexcept {
+    if constexpr (reduction_kernels::is_byte_v<T>) {
+        return reduction_kernels::count(
+            reinterpret_cast<const unsigned char*>(data),
+            size,
+            reduction_kernels::byte(value)
+        );
+    } else {
+        std::size_t result = 0;
+        for (std::size_t i = 0; i < size; ++i) {
+            result += data[i] == value;
+        }
+        return result;
+    }
+}
+
+// Counts the values of a contiguous range equal to the provided one
+template <class Range>
+std::size_t column_count(
+    const Range& range,
+    const typename Range::value_type& value
+) noexcept {
+    return column_count(std::data(range), std::size(range), value);
+}
+
+// Counts the values of a compartment column equal to the provided one
+template <class States, class Container>
+std::size_t column_count(
+    const compartment_column<States, Container>& column,
+    typename compartment_column<States, Container>::value_type value
+) noexcept {
+    return column.count(value);
+}
+// ========================================================================== //
+
+
+
+// ============================ COLUMN MIN AND MAX ========================== //
+// Returns the minimum of a non-empty column
+template <class T>
+T column_min(const T* data, std::size_t size) noexcept {
+    if constexpr (std::is_same_v<T, double> || std::is_same_v<T, float>) {
+        return reduction_kernels::extremum<false>(data, size);
+    } else {
+        return *std::min_element(data, data + size);
+    }
+}
+
+// Returns the minimum of a non-empty contiguous range
+template <class Range>
+auto column_min(const Range& range) noexcept {
+    return column_min(std::data(range), std::size(range));
+}
+
+// Returns the maximum of a non-empty column
+template <class T>
+T column_max(const T* data, std::size_t size) noexcept {
+    if constexpr (std::is_same_v<T, double> || std::is_same_v<T, float>) {
+        return reduction_kernels::extremum<true>(data, size);
+    } else {
+        return *std::max_element(data, data + size);
+    }
+}
+
+// Returns the maximum of a non-empty contiguous range
+template <class Range>
+auto column_max(const Range& range) noexcept {
+    return column_max(std::data(range), std::size(range));
+}
+// ========================================================================== //
+
+
+
+// ============================ COLUMN HISTOGRAM ============================ //
+// Counts the occurrences of each state of a pack of values in a column, in a
+// single pass over the values
+template <class States, class T>
+std::array<std::size_t, pack_size_v<States>> column_histogram(
+    const T* data,
+    std::size_t size
+) noexcept {
+    constexpr auto states = pack_values_v<States>;
+    constexpr std::size_t count = pack_size_v<States>;
+    std::array<std::size_t, count> result = {};
+    if constexpr (reduction_kernels::is_byte_v<T>) {
+        std::array<unsigned char, count> values = {};
+        for (std::size_t s = 0; s < count; ++s) {
+            values[s] = reduction_kernels::byte(static_cast<T>(states[s]));
+        }
+        reduction_kernels::histogram(
+            reinterpret_cast<const unsigned char*>(data),
+            size,
+            values,
+            result
+        );
+    } else {
+        for (std::size_t i = 0; i < size; ++i) {
+            for (std::size_t s = 0; s < count; ++s) {
+                result[s] += data[i] == static_cast<T>(states[s]);
+            }
+        }
+    }
+    return result;
+}
+
+// Counts the occurrences of each state of a pack of values in a range
+template <class States, class Range>
+std::array<std::size_t, pack_size_v<States>> column_histogram(
+    const Range& range
+) noexcept {
+    return column_histogram<States>(std::data(range), std::size(range));
+}
+
+// Counts the occurrences of each state of a compartment column
+template <class States, class Container>
+std::array<std::size_t, pack_size_v<States>> column_histogram(
+    const compartment_column<States, Container>& column
+) noexcept {
+    return column.counts();
+}
+// ========================================================================== //
+
+
+
+// ========================================================================== //
+} // namespace epidesim
+#endif // _REDUCTIONS_HPP_INCLUDED
+// ========================================================================== //
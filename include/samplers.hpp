@@ -0,0 +1,409 @@
+// ================================ SAMPLERS ================================ //
+// Project:         epidesim
+// Name:            samplers.hpp
+// Description:     Batched samplers of infection and transition draws
+// Creator:         Vincent Reverdy
+// Contributor(s):  Vincent Reverdy [2020-]
+// License:         BSD 3-Clause License
+// ========================================================================== //
+#ifndef _SAMPLERS_HPP_INCLUDED
+#define _SAMPLERS_HPP_INCLUDED
+// ========================================================================== //
+
+
+
+// ============================== PREAMBLE ================================== //
+// C++ standard library
+#include <cmath>
+#include <limits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <algorithm>
+#include <type_traits>
+// Project sources
+#include "random.hpp"
+#include "columns.hpp"
+#include "constants.hpp"
+// Third-party libraries
+// Miscellaneous
+namespace epidesim {
+// ========================================================================== //
+
+
+
+// ============================ SAMPLER KERNELS ============================= //
+// Kernels of the batched samplers: draws are generated by blocks of a few
+// dozen agents, and transformed by branch-free loops that compilers turn into
+// vector instructions, including the logarithm which is evaluated from the
+// bits of its argument rather than through the scalar library function
+struct sampler_kernels {
+    // The number of draws generated at once
+    static constexpr std::size_t block = 64;
+
+    // Returns the parameter of an agent: scalars and constants such as the
+    // ones of scientific_v are shared by all agents and folded at compile
+    // time, while columns are indexed
+    template <class Parameter>
+    static constexpr decltype(auto) parameter(
+        const Parameter& parameter,
+        std::size_t index
+    ) noexcept {
+        if constexpr (std::is_convertible_v<const Parameter&, double>) {
+            return parameter;
+        } else {
+            return parameter[index];
+        }
+    }
+
+    // Converts a probability into a threshold on 32 random bits
+    template <class Real>
+    static constexpr std::uint64_t threshold(Real probability) noexcept {
+        constexpr Real scale = Real(4294967296.);
+        return probability <= Real(0) ? 0
+        : probability >= Real(1) ? std::uint64_t(1) << 32
+        : static_cast<std::uint64_t>(probability * scale);
+    }
+
+    // Computes the natural logarithm of a positive normal number
+    template <class Real>
+    static Real log(Real x) noexcept {
+        static_assert(std::is_floating_point_v<Real>, "not a floating point");
+        using bits_type = std::conditional_t<
+            sizeof(Real) == sizeof(std::uint64_t),
+            std::uint64_t,
+            std::uint32_t
+        >;
+        using signed_type = std::make_signed_t<bits_type>;
+        constexpr int digits = std::numeric_limits<Real>::digits - 1;
+        constexpr signed_type bias = std::numeric_limits<Real>::max_exponent;
+        constexpr bits_type mantissa = (bits_type(1) << digits) - 1;
+        constexpr bits_type one = bits_type(bias - 1) << digits;
+        constexpr Real sqrt2 = Real(1.41421356237309504880);
+        constexpr Real ln2 = Real(0.69314718055994530942);
+        bits_type bits = 0;
+        std::memcpy(&bits, &x, sizeof(Real));
+        Real exponent = static_cast<Real>(
+            static_cast<signed_type>(bits >> digits) - (bias - 1)
+        );
+        bits = (bits & mantissa) | one;
+        Real m = Real(0);
+        std::memcpy(&m, &bits, sizeof(Real));
+        const bool high = m > sqrt2;
+        m = high ? m * Real(0.5) : m;
+        exponent += high ? Real(1) : Real(0);
+        const Real f = (m - Real(1)) / (m + Real(1));
+        const Real f2 = f * f;
+        Real series = Real(0);
+        if constexpr (sizeof(Real) == sizeof(std::uint64_t)) {
+            series = Real(1) / Real(21);
+            series = series * f2 + Real(1) / Real(19);
+            series = series * f2 + Real(1) / Real(17);
+            series = series * f2 + Real(1) / Real(15);
+            series = series * f2 + Real(1) / Real(13);
+            series = series * f2 + Real(1) / Real(11);
+            series = series * f2 + Real(1) / Real(9);
+        } else {
+            series = Real(1) / Real(9);
+        }
+        series = series * f2 + Real(1) / Real(7);
+        series = series * f2 + Real(1) / Real(5);
+        series = series * f2 + Real(1) / Real(3);
+        series = series * f2 + Real(1);
+        return exponent * ln2 + Real(2) * f * series;
+    }
+};
+// ========================================================================== //
+
+
+
+// ============================ BERNOULLI SAMPLER =========================== //
+// Draws a Bernoulli trial for each agent of a range, with a probability given
+// per agent by a column or shared as a scalar or a compile-time constant, and
+// packs the successes into a mask of one bit per agent compatible with the
+// transitions of compartment columns: returns the number of successes
+template <class Bijection, class Probability>
+std::size_t sample_bernoulli(
+    const counter_based_rng<Bijection>& rng,
+    std::uint32_t first,
+    std::size_t count,
+    const Probability& probability,
+    std::uint64_t* mask,
+    std::uint32_t draw = 0
+) noexcept {
+    constexpr std::size_t block = sampler_kernels::block;
+    std::uint32_t bits[block] = {};
+    std::size_t result = 0;
+    for (std::size_t i = 0; i < count; i += block) {
+        const std::size_t size = std::min(block, count - i);
+        rng.fill_bits(first + static_cast<std::uint32_t>(i), bits, size, draw);
+        std::uint64_t word = 0;
+        for (std::size_t lane = 0; lane < size; ++lane) {
+            const std::uint64_t limit = sampler_kernels::threshold(
+                static_cast<double>(
+                    sampler_kernels::parameter(probability, i + lane)
+                )
+            );
+            word |= std::uint64_t(bits[lane] < limit) << lane;
+        }
+        mask[i / block] = word;
+        result += popcount(word);
+    }
+    return result;
+}
+
+// Draws a Bernoulli trial for each agent, sizing the mask container
+template <class Bijection, class Probability, class Mask>
+std::size_t sample_bernoulli(
+    const counter_based_rng<Bijection>& rng,
+    std::uint32_t first,
+    std::size_t count,
+    const Probability& probability,
+    Mask& mask,
+    std::uint32_t draw = 0
+) {
+    mask.resize((count + sampler_kernels::block - 1) / sampler_kernels::block);
+    return sample_bernoulli(
+        rng,
+        first,
+        count,
+        probability,
+        std::data(mask),
+        draw
+    );
+}
+// ========================================================================== //
+
+
+
+// =========================== EXPONENTIAL SAMPLER ========================== //
+// Draws an exponential dwell time for each agent of a range by inversion,
+// with a rate given per agent by a column or shared as a scalar or a
+// compile-time constant
+template <class Bijection, class Rate, class Real>
+void sample_exponential(
+    const counter_based_rng<Bijection>& rng,
+    std::uint32_t first,
+    std::size_t count,
+    const Rate& rate,
+    Real* output,
+    std::uint32_t draw = 0
+) noexcept {
+    constexpr std::size_t block = sampler_kernels::block;
+    Real uniforms[block] = {};
+    for (std::size_t i = 0; i < count; i += block) {
+        const std::size_t size = std::min(block, count - i);
+        const std::uint32_t agent = first + static_cast<std::uint32_t>(i);
+        rng.fill_uniform(agent, uniforms, size, draw);
+        for (std::size_t lane = 0; lane < size; ++lane) {
+            const Real lambda = static_cast<Real>(
+                sampler_kernels::parameter(rate, i + lane)
+            );
+            output[i + lane] = -sampler_kernels::log(uniforms[lane]) / lambda;
+        }
+    }
+}
+
+// Draws an exponential dwell time for each agent of a contiguous range
+template <class Bijection, class Rate, class Range>
+void sample_exponential(
+    const counter_based_rng<Bijection>& rng,
+    std::uint32_t first,
+    const Rate& rate,
+    Range&& output,
+    std::uint32_t draw = 0
+) noexcept {
+    sample_exponential(
+        rng,
+        first,
+        std::size(output),
+        rate,
+        std::data(output),
+        draw
+    );
+}
+// ========================================================================== //
+
+
+
+// ============================ BINOMIAL SAMPLER ============================ //
+// Draws a binomial variate from an engine of 32-bit words: by inversion when
+// the mean is small, and by the BTPE algorithm of Kachitvichyanukul and
+// Schmeiser otherwise, so that the expected cost is bounded whatever the
+// parameters
+template <class Engine, class Real>
+std::uint64_t binomial_variate(
+    Engine& engine,
+    std::uint64_t trials,
+    Real probability
+) {
+    const auto uniform = [&engine]{
+        return (static_cast<double>(engine()) + 0.5) / 4294967296.;
+    };
+    const double p = static_cast<double>(probability);
+    if (trials == 0 || p <= 0) {
+        return 0;
+    } else if (p >= 1) {
+        return trials;
+    }
+    const double r = std::min(p, 1 - p);
+    const double q = 1 - r;
+    const double n = static_cast<double>(trials);
+    double y = 0;
+    if (n * r < 30) {
+        const double s = r / q;
+        const double a = (n + 1) * s;
+        const double start = std::pow(q, n);
+        do {
+            double u = uniform();
+            double f = start;
+            for (y = 0; u > f && y <= n; f *= a / y - s) {
+                u -= f;
+                ++y;
+            }
+        } while (y > n);
+    } else {
+        const double fm = n * r + r;
+        const double m = std::floor(fm);
+        const double nrq = n * r * q;
+        const double p1 = std::floor(2.195 * std::sqrt(nrq) - 4.6 * q) + 0.5;
+        const double xm = m + 0.5;
+        const double xl = xm - p1;
+        const double xr = xm + p1;
+        const double c = 0.134 + 20.5 / (15.3 + m);
+        const double al = (fm - xl) / (fm - xl * r);
+        const double lambda_left = al * (1 + al / 2);
+        const double ar = (xr - fm) / (xr * q);
+        const double lambda_right = ar * (1 + ar / 2);
+        const double p2 = p1 * (1 + 2 * c);
+        const double p3 = p2 + c / lambda_left;
+        const double p4 = p3 + c / lambda_right;
+        const auto stirling = [](double x) {
+            const double x2 = x * x;
+            return (13860. - (462. - (132. - (99. - 140. / x2) / x2) / x2) / x2)
+            / x / 166320.;
+        };
+        while (true) {
+            const double u = uniform() * p4;
+            double v = uniform();
+            if (u <= p1) {
+                y = std::floor(xm - p1 * v + u);
+                break;
+            } else if (u <= p2) {
+                const double x = xl + (u - p1) / c;
+                v = v * c + 1 - std::abs(m - x + 0.5) / p1;
+                if (v > 1) {
+                    continue;
+                }
+                y = std::floor(x);
+            } else if (u <= p3) {
+                y = std::floor(xl + std::log(v) / lambda_left);
+                if (y < 0) {
+                    continue;
+                }
+                v = v * (u - p2) * lambda_left;
+            } else {
+                y = std::floor(xr - std::log(v) / lambda_right);
+                if (y > n) {
+                    continue;
+                }
+                v = v * (u - p3) * lambda_right;
+            }
+            const double k = std::abs(y - m);
+            if (k <= 20 || k >= nrq / 2 - 1) {
+                const double s = r / q;
+                const double a = s * (n + 1);
+                double f = 1;
+                for (double i = m + 1; i <= y; ++i) {
+                    f *= a / i - s;
+                }
+                for (double i = y + 1; i <= m; ++i) {
+                    f /= a / i - s;
+                }
+                if (v <= f) {
+                    break;
+                }
+                continue;
+            }
+            const double rho = (k / nrq)
+            * ((k * (k / 3 + 0.625) + 0.1666666666666667) / nrq + 0.5);
+            const double t = -k * k / (2 * nrq);
+            const double alpha = std::log(v);
+            if (alpha < t - rho) {
+                break;
+            } else if (alpha > t + rho) {
+                continue;
+            }
+            const double x1 = y + 1;
+            const double f1 = m + 1;
+            const double z = n + 1 - m;
+            const double w = n - y + 1;
+            const double bound = xm * std::log(f1 / x1)
+            + (n - m + 0.5) * std::log(z / w)
+            + (y - m) * std::log(w * r / (x1 * q))
+            + stirling(f1) + stirling(z) + stirling(x1) + stirling(w);
+            if (alpha <= bound) {
+                break;
+            }
+        }
+    }
+    return static_cast<std::uint64_t>(p > 0.5 ? n - y : y);
+}
+
+// Draws a binomial variate for each agent of a range, with a number of trials
+// and a probability given per agent by columns or shared as scalars or
+// compile-time constants: the variate of an agent consumes the consecutive
+// draw indices starting at the provided one
+template <class Bijection, class Trials, class Probability, class Integer>
+void sample_binomial(
+    const counter_based_rng<Bijection>& rng,
+    std::uint32_t first,
+    std::size_t count,
+    const Trials& trials,
+    const Probability& probability,
+    Integer* output,
+    std::uint32_t draw = 0
+) {
+    for (std::size_t i = 0; i < count; ++i) {
+        agent_engine<Bijection> engine(
+            rng,
+            first + static_cast<std::uint32_t>(i),
+            draw
+        );
+        output[i] = static_cast<Integer>(binomial_variate(
+            engine,
+            static_cast<std::uint64_t>(sampler_kernels::parameter(trials, i)),
+            static_cast<double>(sampler_kernels::parameter(probability, i))
+        ));
+    }
+}
+
+// Draws a binomial variate for each agent of a contiguous range
+template <class Bijection, class Trials, class Probability, class Range>
+void sample_binomial(
+    const counter_based_rng<Bijection>& rng,
+    std::uint32_t first,
+    const Trials& trials,
+    const Probability& probability,
+    Range&& output,
+    std::uint32_t draw = 0
+) {
+    sample_binomial(
+        rng,
+        first,
+        std::size(output),
+        trials,
+        probability,
+        std::data(output),
+        draw
+    );
+}
+// ========================================================================== //
+
+
+
+// ========================================================================== //
+} // namespace epidesim
+#endif // _SAMPLERS_HPP_INCLUDED
+// ========================================================================== //
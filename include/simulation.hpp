@@ -0,0 +1,366 @@
+// =============================== SIMULATION =============================== //
+// Project:         epidesim
+// Name:            simulation.hpp
+// Description:     Tick-based simulation engine over double-buffered agents
+// Creator:         Vincent Reverdy
+// Contributor(s):  Vincent Reverdy [2020-]
+// License:         BSD 3-Clause License
+// ========================================================================== //
+#ifndef _SIMULATION_HPP_INCLUDED
+#define _SIMULATION_HPP_INCLUDED
+// ========================================================================== //
+
+
+
+// ============================== PREAMBLE ================================== //
+// C++ standard library
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <type_traits>
+// Project sources
+#include "pack.hpp"
+#include "stores.hpp"
+// Third-party libraries
+// Miscellaneous
+namespace epidesim {
+// ========================================================================== //
+
+
+
+// ============================= DOUBLE BUFFERED ============================ //
+// Marks an attribute of a schema as mutable during a simulation, so that it is
+// stored twice: once for the state being read, and once for the state being
+// written during a tick
+template <class Type>
+struct double_buffered {
+    using type = Type;
+};
+
+// Checks if an attribute is double buffered: not double buffered
+template <class T>
+struct is_double_buffered: std::false_type {};
+
+// Checks if an attribute is double buffered: double buffered
+template <class Type>
+struct is_double_buffered<double_buffered<Type>>: std::true_type {};
+
+// Variable template
+template <class T>
+inline constexpr bool is_double_buffered_v = is_double_buffered<T>::value;
+
+// Removes the double buffering mark of an attribute: not double buffered
+template <class T>
+struct remove_double_buffered {
+    using type = T;
+};
+
+// Removes the double buffering mark of an attribute: double buffered
+template <class Type>
+struct remove_double_buffered<double_buffered<Type>> {
+    using type = Type;
+};
+
+// Alias template
+template <class T>
+using remove_double_buffered_t = typename remove_double_buffered<T>::type;
+// ========================================================================== //
+
+
+
+// ============================ SCHEMA PARTITION ============================ //
+// Splits a schema into its immutable attributes and its double buffered ones:
+// declaration
+template <class Schema>
+struct schema_partition;
+
+// Splits a schema into its immutable attributes and its double buffered ones:
+// type pack specialization
+template <class... Types>
+struct schema_partition<type_pack<Types...>> {
+    using constant_type = pack_concat_t<std::conditional_t<
+        is_double_buffered_v<Types>,
+        type_pack<>,
+        type_pack<Types>
+    >...>;
+    using mutable_type = pack_concat_t<std::conditional_t<
+        is_double_buffered_v<Types>,
+        type_pack<remove_double_buffered_t<Types>>,
+        type_pack<>
+    >...>;
+};
+// ========================================================================== //
+
+
+
+// =============================== SIMULATION =============================== //
+// A tick-based simulation of agents described by a schema: immutable
+// attributes are stored once, and attributes marked as double buffered are
+// read from the current buffer and written to the next one, which are swapped
+// at the end of each tick, so that all agents can be updated in parallel
+// without locks nor ordering hazards. The next buffer starts each tick as a
+// copy of the current one, made by blocks of agents with the executor of the
+// tick, so that kernels only write what changes. Columns
+// packing several agents per word are safe to update in parallel as long as
+// the chunks of the executor are multiples of 64 agents: declaration
+template <class Schema, class Container = std::vector<std::byte>>
+class simulation;
+
+// A tick-based simulation of agents described by a schema: specialization
+template <class... Types, class Container>
+class simulation<type_pack<Types...>, Container>
+{
+    // Types
+    public:
+    using schema_type = type_pack<Types...>;
+    using container_type = Container;
+    using constant_schema = typename schema_partition<
+        schema_type
+    >::constant_type;
+    using mutable_schema = typename schema_partition<
+        schema_type
+    >::mutable_type;
+    using constant_store_type = soa_store<constant_schema, container_type>;
+    using buffer_type = soa_store<mutable_schema, container_type>;
+    using size_type = std::size_t;
+    using tick_type = std::uint32_t;
+    class frame;
+
+    // Constants
+    public:
+    static constexpr size_type copy_chunk = 16384;
+
+    // Helpers
+    private:
+    template <class Type>
+    static constexpr bool _is_mutable
+    = (std::is_same_v<double_buffered<Type>, Types> || ...);
+
+    // Lifecycle
+    public:
+    simulation() = default;
+    explicit simulation(size_type count) {
+        resize(count);
+    }
+
+    // Capacity
+    public:
+    bool empty() const noexcept {
+        return size() == 0;
+    }
+    size_type size() const noexcept {
+        return _size;
+    }
+    void reserve(size_type count) {
+        _constants.reserve(count);
+        _buffers[0].reserve(count);
+        _buffers[1].reserve(count);
+    }
+    void resize(size_type count) {
+        _constants.resize(count);
+        _buffers[0].resize(count);
+        _buffers[1].resize(count);
+        _size = count;
+    }
+
+    // Access
+    public:
+    tick_type tick() const noexcept {
+        return _tick;
+    }
+    const constant_store_type& constants() const noexcept {
+        return _constants;
+    }
+    const buffer_type& current() const noexcept {
+        return _buffers[_front];
+    }
+    template <class Type>
+    auto& column() noexcept {
+        if constexpr (_is_mutable<Type>) {
+            return _buffers[_front].template column<Type>();
+        } else {
+            return _constants.template column<Type>();
+        }
+    }
+    template <class Type>
+    const auto& column() const noexcept {
+        if constexpr (_is_mutable<Type>) {
+            return _buffers[_front].template column<Type>();
+        } else {
+            return _constants.template column<Type>();
+        }
+    }
+    template <class Type>
+    auto& next_column() noexcept {
+        static_assert(_is_mutable<Type>, "only mutable columns are buffered");
+        return _buffers[!_front].template column<Type>();
+    }
+    template <class Function>
+    void for_each_store(Function&& function) {
+        function(_constants);
+        function(_buffers[0]);
+        function(_buffers[1]);
+    }
+
+    // Execution
+    public:
+    template <class Kernel>
+    void step(Kernel&& kernel) {
+        _prepare();
+        const frame current(*this);
+        for (size_type i = 0; i < _size; ++i) {
+            kernel(current, i);
+        }
+        _swap();
+    }
+    template <class Executor, class Kernel>
+    void step(Executor& executor, Kernel&& kernel) {
+        step(executor, Executor::default_chunk, kernel);
+    }
+    template <class Executor, class Kernel>
+    void step(Executor& executor, size_type chunk, Kernel&& kernel) {
+        _prepare(executor);
+        const frame current(*this);
+        executor.parallel_for(0, _size, chunk, [&](size_type i) {
+            kernel(current, i);
+        });
+        _swap();
+    }
+    template <class Kernel>
+    void run(size_type ticks, Kernel&& kernel) {
+        for (size_type i = 0; i < ticks; ++i) {
+            step(kernel);
+        }
+    }
+    template <class Executor, class Kernel>
+    void run(Executor& executor, size_type ticks, Kernel&& kernel) {
+        run(executor, ticks, Executor::default_chunk, kernel);
+    }
+    template <class Executor, class Kernel>
+    void run(
+        Executor& executor,
+        size_type ticks,
+        size_type chunk,
+        Kernel&& kernel
+    ) {
+        for (size_type i = 0; i < ticks; ++i) {
+            step(executor, chunk, kernel);
+        }
+    }
+
+    // Implementation details
+    private:
+    void _prepare() {
+        _copy(std::make_index_sequence<pack_size_v<mutable_schema>>());
+    }
+    template <class Executor>
+    void _prepare(Executor& executor) {
+        _copy(
+            executor,
+            std::make_index_sequence<pack_size_v<mutable_schema>>()
+        );
+    }
+    template <std::size_t... Indices>
+    void _copy(std::index_sequence<Indices...>) {
+        buffer_type& back = _buffers[!_front];
+        const buffer_type& front = _buffers[_front];
+        ((back.template column<Indices>() = front.template column<Indices>()),
+        ...);
+    }
+    template <class Executor, std::size_t... Indices>
+    void _copy(Executor& executor, std::index_sequence<Indices...>) {
+        buffer_type& back = _buffers[!_front];
+        const buffer_type& front = _buffers[_front];
+        const size_type blocks = (_size + copy_chunk - 1) / copy_chunk;
+        executor.parallel_for(0, blocks, 1, [&](size_type block) {
+            const size_type first = block * copy_chunk;
+            const size_type last = std::min(first + copy_chunk, _size);
+            (_copy(
+                front.template column<Indices>(),
+                back.template column<Indices>(),
+                first,
+                last
+            ), ...);
+        });
+    }
+    template <class Column>
+    static void _copy(
+        const Column& source,
+        Column& destination,
+        size_type first,
+        size_type last
+    ) {
+        using difference_type = typename std::iterator_traits<
+            decltype(std::begin(source))
+        >::difference_type;
+        std::copy(
+            std::next(std::begin(source), difference_type(first)),
+            std::next(std::begin(source), difference_type(last)),
+            std::next(std::begin(destination), difference_type(first))
+        );
+    }
+    void _swap() noexcept {
+        _front = !_front;
+        ++_tick;
+    }
+    constant_store_type _constants;
+    buffer_type _buffers[2];
+    size_type _size = 0;
+    tick_type _tick = 0;
+    bool _front = false;
+};
+
+// The view of a simulation given to kernels during a tick: attributes are
+// read from the constants and the current buffer, and written to the next one
+template <class... Types, class Container>
+class simulation<type_pack<Types...>, Container>::frame
+{
+    // Types
+    public:
+    using simulation_type = simulation<type_pack<Types...>, Container>;
+    using size_type = typename simulation_type::size_type;
+    using tick_type = typename simulation_type::tick_type;
+
+    // Lifecycle
+    public:
+    explicit frame(simulation_type& simulation) noexcept
+    : _simulation(&simulation) {
+    }
+
+    // Access
+    public:
+    tick_type tick() const noexcept {
+        return _simulation->tick();
+    }
+    size_type size() const noexcept {
+        return _simulation->size();
+    }
+    template <class Type>
+    decltype(auto) get(size_type index) const noexcept {
+        const simulation_type& simulation = *_simulation;
+        return simulation.template column<Type>()[index];
+    }
+    template <class Type>
+    decltype(auto) next(size_type index) const noexcept {
+        return _simulation->template next_column<Type>()[index];
+    }
+    template <class Type, class Value>
+    void set(size_type index, Value&& value) const {
+        next<Type>(index) = std::forward<Value>(value);
+    }
+
+    // Implementation details
+    private:
+    simulation_type* _simulation;
+};
+// ========================================================================== //
+
+
+
+// ========================================================================== //
+} // namespace epidesim
+#endif // _SIMULATION_HPP_INCLUDED
+// ========================================================================== //
@@ -0,0 +1,360 @@
+// ================================ SPATIAL ================================= //
+// Project:         epidesim
+// Name:            spatial.hpp
+// Description:     Cell lists for proximity-based contacts
+// Creator:         Vincent Reverdy
+// Contributor(s):  Vincent Reverdy [2020-]
+// License:         BSD 3-Clause License
+// ========================================================================== //
+#ifndef _SPATIAL_HPP_INCLUDED
+#define _SPATIAL_HPP_INCLUDED
+// ========================================================================== //
+
+
+
+// ============================== PREAMBLE ================================== //
+// C++ standard library
+#include <cmath>
+#include <atomic>
+#include <limits>
+#include <vector>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <type_traits>
+// Project sources
+#include "bases.hpp"
+#include "parallel.hpp"
+// Third-party libraries
+// Miscellaneous
+namespace epidesim {
+// ========================================================================== //
+
+
+
+// ========================== NEIGHBORHOOD ITERATOR ========================= //
+// A forward iterator over the agents of a block of cells of a cell list: the
+// cells of a row of the block are consecutive, so that the agents of the
+// block are read from at most three contiguous spans
+template <class CellList>
+class neighborhood_iterator
+{
+    // Types
+    public:
+    using cell_list_type = CellList;
+    using index_type = typename cell_list_type::index_type;
+    using size_type = typename cell_list_type::size_type;
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = index_type;
+    using difference_type = std::ptrdiff_t;
+    using reference = const index_type&;
+    using pointer = const index_type*;
+
+    // Lifecycle
+    public:
+    constexpr neighborhood_iterator() noexcept = default;
+    neighborhood_iterator(
+        const cell_list_type& cells,
+        size_type row,
+        size_type last_row,
+        size_type first_column,
+        size_type last_column
+    ) noexcept
+    : _cells(&cells)
+    , _row(row)
+    , _last_row(last_row)
+    , _first_column(first_column)
+    , _last_column(last_column) {
+        _enter();
+        _skip();
+    }
+    neighborhood_iterator(
+        const cell_list_type& cells,
+        size_type position
+    ) noexcept
+    : _cells(&cells), _position(position), _end(position) {
+    }
+
+    // Access
+    public:
+    reference operator*() const noexcept {
+        return _cells->agents()[_position];
+    }
+    pointer operator->() const noexcept {
+        return std::addressof(**this);
+    }
+
+    // Increment
+    public:
+    neighborhood_iterator& operator++() noexcept {
+        ++_position;
+        _skip();
+        return *this;
+    }
+    neighborhood_iterator operator++(int) noexcept {
+        neighborhood_iterator self = *this;
+        ++*this;
+        return self;
+    }
+
+    // Comparison
+    public:
+    friend constexpr bool operator==(
+        const neighborhood_iterator& lhs,
+        const neighborhood_iterator& rhs
+    ) noexcept {
+        return lhs._position == rhs._position;
+    }
+    friend constexpr bool operator!=(
+        const neighborhood_iterator& lhs,
+        const neighborhood_iterator& rhs
+    ) noexcept {
+        return lhs._position != rhs._position;
+    }
+
+    // Implementation details
+    private:
+    void _enter() noexcept {
+        const size_type columns = _cells->columns();
+        _position = _cells->offsets()[_row * columns + _first_column];
+        _end = _cells->offsets()[_row * columns + _last_column + 1];
+    }
+    void _skip() noexcept {
+        while (_position == _end && _row < _last_row) {
+            ++_row;
+            _enter();
+        }
+    }
+    const cell_list_type* _cells = nullptr;
+    size_type _row = 0;
+    size_type _last_row = 0;
+    size_type _first_column = 0;
+    size_type _last_column = 0;
+    size_type _position = 0;
+    size_type _end = 0;
+};
+// ========================================================================== //
+
+
+
+// =============================== CELL LIST ================================ //
+// A uniform grid of square cells over a rectangular domain, listing the
+// agents of each cell contiguously: agents are sorted by cell through a
+// counting sort on their coordinates, read from the columns of a structure of
+// arrays, executed in parallel when an executor is provided, and the sort is
+// skipped when no agent changed cell since the last update, reusing the
+// storage across ticks. Agents closer than the side of a cell are in the same
+// or in adjacent cells, so that contacts within that distance are found by
+// scanning the neighborhoods of cells instead of all pairs of agents, as long
+// as the radius of contacts does not exceed the side of cells. Agents outside
+// of the domain, including at infinity, are clamped to its borders, and NaN
+// coordinates are mapped to the first row or column
+template <class Real = double>
+class cell_list
+{
+    // Types
+    public:
+    using real_type = Real;
+    using index_type = std::uint32_t;
+    using size_type = std::size_t;
+    using iterator = neighborhood_iterator<cell_list>;
+    using range_type = iterator_range<iterator>;
+    using span_type = iterator_range<const index_type*>;
+
+    // Constants
+    public:
+    static constexpr size_type update_block = 4096;
+
+    // Lifecycle
+    public:
+    cell_list(
+        real_type side,
+        real_type xmin,
+        real_type ymin,
+        real_type xmax,
+        real_type ymax
+    )
+    : _side(side)
+    , _xmin(xmin)
+    , _ymin(ymin)
+    , _columns(_count(xmax - xmin, side))
+    , _rows(_count(ymax - ymin, side))
+    , _offsets(_columns * _rows + 1) {
+    }
+
+    // Capacity
+    public:
+    bool empty() const noexcept {
+        return _agents.empty();
+    }
+    size_type size() const noexcept {
+        return _agents.size();
+    }
+    size_type cells() const noexcept {
+        return _columns * _rows;
+    }
+    size_type columns() const noexcept {
+        return _columns;
+    }
+    size_type rows() const noexcept {
+        return _rows;
+    }
+    real_type side() const noexcept {
+        return _side;
+    }
+
+    // Update
+    public:
+    template <class Abscissas, class Ordinates>
+    size_type update(const Abscissas& x, const Ordinates& y) {
+        sequential_executor executor;
+        return update(executor, x, y);
+    }
+    template <class Executor, class Abscissas, class Ordinates>
+    size_type update(
+        Executor& executor,
+        const Abscissas& x,
+        const Ordinates& y
+    ) {
+        const size_type size = std::size(x);
+        const size_type blocks = (size + update_block - 1) / update_block;
+        std::atomic<size_type> moved = 0;
+        _cell.resize(size, std::numeric_limits<index_type>::max());
+        executor.parallel_for(0, blocks, 1, [&](size_type block) {
+            const size_type last = std::min(size, (block + 1) * update_block);
+            size_type count = 0;
+            for (size_type i = block * update_block; i < last; ++i) {
+                const index_type cell = locate(x[i], y[i]);
+                count += cell != _cell[i];
+                _cell[i] = cell;
+            }
+            moved.fetch_add(count, std::memory_order_relaxed);
+        });
+        if (moved > 0 || size != _agents.size()) {
+            counting_sort(executor, size, cells(), [this](size_type i) {
+                return _cell[i];
+            }, _offsets, _agents, _counts);
+        }
+        return moved;
+    }
+
+    // Access
+    public:
+    index_type locate(real_type x, real_type y) const noexcept {
+        const size_type column = _clamp((x - _xmin) / _side, _columns);
+        const size_type row = _clamp((y - _ymin) / _side, _rows);
+        return static_cast<index_type>(row * _columns + column);
+    }
+    index_type cell(index_type agent) const noexcept {
+        return _cell[agent];
+    }
+    span_type agents(size_type cell) const noexcept {
+        const index_type* data = _agents.data();
+        return span_type(data + _offsets[cell], data + _offsets[cell + 1]);
+    }
+    range_type neighbors(size_type cell) const noexcept {
+        const size_type row = cell / _columns;
+        const size_type column = cell % _columns;
+        const size_type first_row = row > 0 ? row - 1 : row;
+        const size_type last_row = std::min(row + 1, _rows - 1);
+        const size_type first_column = column > 0 ? column - 1 : column;
+        const size_type last_column = std::min(column + 1, _columns - 1);
+        const size_type end = _offsets[last_row * _columns + last_column + 1];
+        return range_type(
+            iterator(*this, first_row, last_row, first_column, last_column),
+            iterator(*this, end)
+        );
+    }
+    range_type neighbors_of(index_type agent) const noexcept {
+        return neighbors(_cell[agent]);
+    }
+    const std::vector<index_type>& agents() const noexcept {
+        return _agents;
+    }
+    const std::vector<size_type>& offsets() const noexcept {
+        return _offsets;
+    }
+
+    // Contacts
+    public:
+    template <class Abscissas, class Ordinates, class Function>
+    void contacts(
+        const Abscissas& x,
+        const Ordinates& y,
+        real_type radius,
+        Function&& function
+    ) const {
+        assert(radius <= _side);
+        for (size_type cell = 0; cell < cells(); ++cell) {
+            _contacts(cell, x, y, radius, function);
+        }
+    }
+    template <class Executor, class Abscissas, class Ordinates, class Function>
+    void contacts(
+        Executor& executor,
+        const Abscissas& x,
+        const Ordinates& y,
+        real_type radius,
+        Function&& function
+    ) const {
+        assert(radius <= _side);
+        executor.parallel_for(0, cells(), _columns, [&](size_type cell) {
+            _contacts(cell, x, y, radius, function);
+        });
+    }
+
+    // Implementation details
+    private:
+    static size_type _count(real_type extent, real_type side) noexcept {
+        return std::max(
+            static_cast<size_type>(std::ceil(extent / side)),
+            size_type(1)
+        );
+    }
+    static size_type _clamp(real_type position, size_type count) noexcept {
+        return !(position > real_type(0)) ? 0
+        : position < static_cast<real_type>(count - 1)
+        ? static_cast<size_type>(position)
+        : count - 1;
+    }
+    template <class Abscissas, class Ordinates, class Function>
+    void _contacts(
+        size_type cell,
+        const Abscissas& x,
+        const Ordinates& y,
+        real_type radius,
+        Function& function
+    ) const {
+        const real_type squared = radius * radius;
+        const range_type neighborhood = neighbors(cell);
+        for (const index_type agent: agents(cell)) {
+            for (const index_type other: neighborhood) {
+                const real_type dx = x[agent] - x[other];
+                const real_type dy = y[agent] - y[other];
+                if (agent < other && dx * dx + dy * dy <= squared) {
+                    function(agent, other);
+                }
+            }
+        }
+    }
+    real_type _side;
+    real_type _xmin;
+    real_type _ymin;
+    size_type _columns;
+    size_type _rows;
+    std::vector<size_type> _offsets;
+    std::vector<index_type> _agents;
+    std::vector<index_type> _cell;
+    std::vector<size_type> _counts;
+};
+// ========================================================================== //
+
+
+
+// ========================================================================== //
+} // namespace epidesim
+#endif // _SPATIAL_HPP_INCLUDED
+// ========================================================================== //
@@ -0,0 +1,402 @@
+// ================================= STORES ================================= //
+// Project:         epidesim
+// Name:            stores.hpp
+// Description:     Agent stores laid out according to a schema of attributes
+// Creator:         Vincent Reverdy
+// Contributor(s):  Vincent Reverdy [2020-]
+// License:         BSD 3-Clause License
+// ========================================================================== //
+#ifndef _STORES_HPP_INCLUDED
+#define _STORES_HPP_INCLUDED
+// ========================================================================== //
+
+
+
+// ============================== PREAMBLE ================================== //
+// C++ standard library
+#include <array>
+#include <vector>
+#include <cstddef>
+#include <utility>
+#include <type_traits>
+// Project sources
+#include "pack.hpp"
+#include "traits.hpp"
+#include "wrappers.hpp"
+#include "constants.hpp"
+// Third-party libraries
+// Miscellaneous
+namespace epidesim {
+// ========================================================================== //
+
+
+
+// ============================ COLUMN CONTAINER ============================ //
+// Selects the container of a column of attributes: by default, the container
+// template of the store rebound to the attribute type, but it can be
+// specialized for attributes requiring a dedicated storage
+template <class Type, class Container, class = void>
+struct column_container {
+    using type = rebind_container_t<Container, Type>;
+};
+
+// Alias template
+template <class Type, class Container>
+using column_container_t = typename column_container<Type, Container>::type;
+// ========================================================================== //
+
+
+
+// ================================ SOA COLUMN ============================== //
+// An indexed column of a structure of arrays, accessible as a pack element
+template <std::size_t Index, class Type, class Container>
+struct soa_column: pack_element_base<
+    Index,
+    type_wrapper<Type>,
+    soa_column<Index, Type, Container>
+> {
+    using base = typename soa_column::pack_element_base;
+    using index_type = typename base::index_type;
+    using wrapper_type = typename base::wrapper_type;
+    using value_type = Type;
+    using container_type = column_container_t<Type, Container>;
+    constexpr container_type& operator[](index_type) noexcept {
+        return column;
+    }
+    constexpr const container_type& operator[](index_type) const noexcept {
+        return column;
+    }
+    constexpr container_type& operator[](wrapper_type) noexcept {
+        return column;
+    }
+    constexpr const container_type& operator[](wrapper_type) const noexcept {
+        return column;
+    }
+    container_type column;
+};
+// ========================================================================== //
+
+
+
+// ================================ SOA STORE =============================== //
+// The base class of a structure of arrays: declaration
+template <class Indices, class Container, class... Types>
+struct soa_store_base;
+
+// The base class of a structure of arrays: indexing specialization
+template <std::size_t... Indices, class Container, class... Types>
+struct soa_store_base<std::index_sequence<Indices...>, Container, Types...>
+: pack_base<soa_column<Indices, Types, Container>...> {
+    using base = typename soa_store_base::pack_base;
+    using is_pack = std::false_type;
+    using schema_type = type_pack<Types...>;
+    using size_type = std::size_t;
+    static constexpr size_type columns() noexcept {
+        return sizeof...(Types);
+    }
+    template <std::size_t Index>
+    constexpr auto& column() noexcept {
+        return this->template get<Index>().column;
+    }
+    template <std::size_t Index>
+    constexpr const auto& column() const noexcept {
+        return this->template get<Index>().column;
+    }
+    template <class Type>
+    constexpr auto& column() noexcept {
+        return this->template get<type_wrapper<Type>>().column;
+    }
+    template <class Type>
+    constexpr const auto& column() const noexcept {
+        return this->template get<type_wrapper<Type>>().column;
+    }
+    template <class Type>
+    constexpr decltype(auto) value(size_type index) noexcept {
+        return column<Type>()[index];
+    }
+    template <class Type>
+    constexpr decltype(auto) value(size_type index) const noexcept {
+        return column<Type>()[index];
+    }
+    template <class Function>
+    constexpr void for_each_column(Function&& function) {
+        (function(column<Indices>()), ...);
+    }
+    template <class Function>
+    constexpr void for_each_column(Function&& function) const {
+        (function(column<Indices>()), ...);
+    }
+    bool empty() const noexcept {
+        return size() == 0;
+    }
+    size_type size() const noexcept {
+        if constexpr (sizeof...(Types) > 0) {
+            return column<0>().size();
+        } else {
+            return 0;
+        }
+    }
+    void reserve(size_type count) {
+        if constexpr (sizeof...(Types) > 0) {
+            (column<Indices>().reserve(count), ...);
+        }
+    }
+    void resize(size_type count) {
+        if constexpr (sizeof...(Types) > 0) {
+            (column<Indices>().resize(count), ...);
+        }
+    }
+    void clear() noexcept {
+        (column<Indices>().clear(), ...);
+    }
+    template <class... Args, class = std::enable_if_t<
+        sizeof...(Args) == sizeof...(Types)
+    >>
+    void push_back(Args&&... args) {
+        (column<Indices>().push_back(std::forward<Args>(args)), ...);
+    }
+    void pop_back() {
+        (column<Indices>().pop_back(), ...);
+    }
+};
+
+// A structure of arrays storing one contiguous column per attribute type of
+// the schema, so that kernels only stream the attributes they use
+template <class Schema, class Container = std::vector<std::byte>>
+struct soa_store;
+
+// A structure of arrays: type pack specialization
+template <class... Types, class Container>
+struct soa_store<type_pack<Types...>, Container>: soa_store_base<
+    std::index_sequence_for<Types...>,
+    Container,
+    Types...
+> {
+    using base = typename soa_store::soa_store_base;
+};
+// ========================================================================== //
+
+
+
+// =============================== AOSOA ARRAY ============================== //
+// An indexed array of attributes within a tile, accessible as a pack element
+template <std::size_t Index, class Type, class Width>
+struct aosoa_array: pack_element_base<
+    Index,
+    type_wrapper<Type>,
+    aosoa_array<Index, Type, Width>
+> {
+    using base = typename aosoa_array::pack_element_base;
+    using index_type = typename base::index_type;
+    using wrapper_type = typename base::wrapper_type;
+    using value_type = Type;
+    using array_type = std::array<Type, Width::value>;
+    constexpr array_type& operator[](index_type) noexcept {
+        return lanes;
+    }
+    constexpr const array_type& operator[](index_type) const noexcept {
+        return lanes;
+    }
+    constexpr array_type& operator[](wrapper_type) noexcept {
+        return lanes;
+    }
+    constexpr const array_type& operator[](wrapper_type) const noexcept {
+        return lanes;
+    }
+    array_type lanes;
+};
+// ========================================================================== //
+
+
+
+// =============================== AOSOA TILE =============================== //
+// The base class of a tile: declaration
+template <class Indices, class Width, class... Types>
+struct aosoa_tile_base;
+
+// The base class of a tile: indexing specialization
+template <std::size_t... Indices, class Width, class... Types>
+struct aosoa_tile_base<std::index_sequence<Indices...>, Width, Types...>
+: pack_base<aosoa_array<Indices, Types, Width>...> {
+    using base = typename aosoa_tile_base::pack_base;
+    using is_pack = std::false_type;
+    using schema_type = type_pack<Types...>;
+    using width_type = Width;
+    static constexpr std::size_t width() noexcept {
+        return width_type::value;
+    }
+    template <std::size_t Index>
+    constexpr auto& lanes() noexcept {
+        return this->template get<Index>().lanes;
+    }
+    template <std::size_t Index>
+    constexpr const auto& lanes() const noexcept {
+        return this->template get<Index>().lanes;
+    }
+    template <class Type>
+    constexpr auto& lanes() noexcept {
+        return this->template get<type_wrapper<Type>>().lanes;
+    }
+    template <class Type>
+    constexpr const auto& lanes() const noexcept {
+        return this->template get<type_wrapper<Type>>().lanes;
+    }
+};
+
+// A tile storing the attributes of a fixed number of agents contiguously for
+// each attribute type of the schema
+template <class Schema, class Width>
+struct aosoa_tile;
+
+// A tile: type pack specialization
+template <class... Types, std::size_t Width>
+struct aosoa_tile<type_pack<Types...>, size_constant<Width>>: aosoa_tile_base<
+    std::index_sequence_for<Types...>,
+    size_constant<Width>,
+    Types...
+> {
+    static_assert(Width > 0, "tiles should hold at least one agent");
+    using base = typename aosoa_tile::aosoa_tile_base;
+};
+// ========================================================================== //
+
+
+
+// =============================== AOSOA STORE ============================== //
+// An array of structures of arrays storing agents in tiles of a compile-time
+// width, typically the number of lanes of a vector register, so that kernels
+// reading several attributes of the same agent stay within a few cache lines
+template <class Schema, class Width, class Container = std::vector<std::byte>>
+class aosoa_store
+{
+    // Types
+    public:
+    using schema_type = Schema;
+    using width_type = Width;
+    using tile_type = aosoa_tile<schema_type, width_type>;
+    using container_type = rebind_container_t<Container, tile_type>;
+    using size_type = typename container_type::size_type;
+
+    // Capacity
+    public:
+    static constexpr size_type columns() noexcept {
+        return pack_size_v<schema_type>;
+    }
+    static constexpr size_type width() noexcept {
+        return width_type::value;
+    }
+    bool empty() const noexcept {
+        return _size == 0;
+    }
+    size_type size() const noexcept {
+        return _size;
+    }
+    size_type tiles() const noexcept {
+        return _tiles.size();
+    }
+    void reserve(size_type count) {
+        _tiles.reserve((count + width() - 1) / width());
+    }
+    void resize(size_type count) {
+        _tiles.resize((count + width() - 1) / width());
+        _size = count;
+    }
+    void clear() noexcept {
+        _tiles.clear();
+        _size = 0;
+    }
+
+    // Modifiers
+    public:
+    template <class... Args, class = std::enable_if_t<
+        sizeof...(Args) == pack_size_v<schema_type>
+    >>
+    void push_back(Args&&... args) {
+        if (_size % width() == 0) {
+            _tiles.emplace_back();
+        }
+        _assign(
+            _tiles.back(),
+            _size % width(),
+            std::make_index_sequence<sizeof...(Args)>(),
+            std::forward<Args>(args)...
+        );
+        ++_size;
+    }
+    void pop_back() {
+        if (--_size % width() == 0) {
+            _tiles.pop_back();
+        }
+    }
+
+    // Access
+    public:
+    tile_type& tile(size_type index) noexcept {
+        return _tiles[index];
+    }
+    const tile_type& tile(size_type index) const noexcept {
+        return _tiles[index];
+    }
+    template <class Type>
+    Type& value(size_type index) noexcept {
+        return tile(index / width()).template lanes<Type>()[index % width()];
+    }
+    template <class Type>
+    const Type& value(size_type index) const noexcept {
+        return tile(index / width()).template lanes<Type>()[index % width()];
+    }
+
+    // Implementation details
+    private:
+    template <std::size_t... Indices, class... Args>
+    static void _assign(
+        tile_type& tile,
+        size_type lane,
+        std::index_sequence<Indices...>,
+        Args&&... args
+    ) {
+        ((tile.template lanes<Indices>()[lane] = std::forward<Args>(args)),
+        ...);
+    }
+    container_type _tiles;
+    size_type _size = 0;
+};
+// ========================================================================== //
+
+
+
+// =============================== AGENT STORE ============================== //
+// Layout storing one contiguous array per attribute
+struct soa_layout {};
+
+// Layout storing tiles of arrays of attributes of the provided width
+template <class Width>
+struct aosoa_layout {};
+
+// Selects the store of a schema with the provided layout: declaration
+template <class Schema, class Layout, class Container = std::vector<std::byte>>
+struct agent_store;
+
+// Selects the store of a schema with the provided layout: structure of arrays
+template <class Schema, class Container>
+struct agent_store<Schema, soa_layout, Container> {
+    using type = soa_store<Schema, Container>;
+};
+
+// Selects the store of a schema with the provided layout: tiled arrays
+template <class Schema, class Width, class Container>
+struct agent_store<Schema, aosoa_layout<Width>, Container> {
+    using type = aosoa_store<Schema, Width, Container>;
+};
+
+// Alias template
+template <class Schema, class Layout, class Container = std::vector<std::byte>>
+using agent_store_t = typename agent_store<Schema, Layout, Container>::type;
+// ========================================================================== //
+
+
+
+// ========================================================================== //
+} // namespace epidesim
+#endif // _STORES_HPP_INCLUDED
+// ========================================================================== //
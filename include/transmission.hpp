@@ -0,0 +1,898 @@
+// ============================== TRANSMISSION ============================== //
+// Project:         epidesim
+// Name:            transmission.hpp
+// Description:     Transmission kernels over contact graphs and locations
+// Creator:         Vincent Reverdy
+// Contributor(s):  Vincent Reverdy [2020-]
+// License:         BSD 3-Clause License
+// ========================================================================== //
+#ifndef _TRANSMISSION_HPP_INCLUDED
+#define _TRANSMISSION_HPP_INCLUDED
+// ========================================================================== //
+
+
+
+// ============================== PREAMBLE ================================== //
+// C++ standard library
+#include <cmath>
+#include <deque>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <vector>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+// Project sources
+#include "random.hpp"
+#include "columns.hpp"
+#include "mobility.hpp"
+#include "parallel.hpp"
+#include "allocators.hpp"
+#include "samplers.hpp"
+// Third-party libraries
+// Miscellaneous
+namespace epidesim {
+// ========================================================================== //
+
+
+
+// ============================= AGENT FRONTIER ============================= //
+// A set of agents stored both as a compact list of indices, whose traversal
+// costs the size of the set, and as a bitmap of one bit per agent of the
+// population, whose membership tests cost a single load: agents can be marked
+// concurrently in the bitmap, and the list is then either collected from the
+// whole bitmap, or gathered from lists of the agents newly marked by each
+// worker after preparing one list per worker, which costs the number of new
+// agents instead of the size of the population. Both keep a sorted list in
+// increasing order
+class agent_frontier
+{
+    // Types
+    public:
+    using index_type = std::uint32_t;
+    using word_type = std::uint64_t;
+    using size_type = std::size_t;
+    using index_container_type = std::vector<index_type>;
+    using const_iterator = index_container_type::const_iterator;
+
+    // Constants
+    public:
+    static constexpr size_type word_bits
+    = std::numeric_limits<word_type>::digits;
+
+    // Lifecycle
+    public:
+    agent_frontier() = default;
+    explicit agent_frontier(size_type universe) {
+        resize(universe);
+    }
+
+    // Capacity
+    public:
+    bool empty() const noexcept {
+        return _indices.empty();
+    }
+    size_type size() const noexcept {
+        return _indices.size();
+    }
+    size_type universe() const noexcept {
+        return _universe;
+    }
+    double density() const noexcept {
+        return _universe ? double(size()) / double(_universe) : 0.;
+    }
+    void resize(size_type universe) {
+        const size_type words = (universe + word_bits - 1) / word_bits;
+        _words.reset(new std::atomic<word_type>[words]);
+        for (size_type i = 0; i < words; ++i) {
+            _words[i].store(0, std::memory_order_relaxed);
+        }
+        _indices.clear();
+        for (index_container_type& pending: _pending) {
+            pending.clear();
+        }
+        _universe = universe;
+    }
+    void clear() noexcept {
+        const size_type words = (_universe + word_bits - 1) / word_bits;
+        if (_indices.size() < words) {
+            for (const index_type index: _indices) {
+                _words[index / word_bits].store(0, std::memory_order_relaxed);
+            }
+        } else {
+            for (size_type i = 0; i < words; ++i) {
+                _words[i].store(0, std::memory_order_relaxed);
+            }
+        }
+        _indices.clear();
+        for (index_container_type& pending: _pending) {
+            pending.clear();
+        }
+    }
+    void prepare(size_type workers) {
+        if (_pending.size() < workers) {
+            _pending.resize(workers);
+        }
+        for (index_container_type& pending: _pending) {
+            pending.clear();
+        }
+    }
+
+    // Membership
+    public:
+    bool contains(index_type index) const noexcept {
+        const word_type word = _words[index / word_bits].load(
+            std::memory_order_relaxed
+        );
+        return (word >> (index % word_bits)) & 1;
+    }
+    bool insert(index_type index) {
+        const bool result = mark(index);
+        if (result) {
+            _indices.push_back(index);
+        }
+        return result;
+    }
+    bool mark(index_type index) noexcept {
+        const word_type bit = word_type(1) << (index % word_bits);
+        const word_type word = _words[index / word_bits].fetch_or(
+            bit,
+            std::memory_order_relaxed
+        );
+        return !(word & bit);
+    }
+    bool mark(index_type index, size_type worker) {
+        assert(worker < _pending.size());
+        const bool result = mark(index);
+        if (result) {
+            _pending[worker].push_back(index);
+        }
+        return result;
+    }
+    void collect() {
+        const size_type words = (_universe + word_bits - 1) / word_bits;
+        _indices.clear();
+        for (size_type i = 0; i < words; ++i) {
+            word_type word = _words[i].load(std::memory_order_relaxed);
+            for (; word; word &= word - 1) {
+                const word_type lowest = word & (~word + 1);
+                _indices.push_back(static_cast<index_type>(
+                    i * word_bits + popcount(lowest - 1)
+                ));
+            }
+        }
+        for (index_container_type& pending: _pending) {
+            pending.clear();
+        }
+    }
+    void gather() {
+        const size_type size = _indices.size();
+        for (index_container_type& pending: _pending) {
+            _indices.insert(_indices.end(), pending.begin(), pending.end());
+            pending.clear();
+        }
+        const auto middle = _indices.begin() + std::ptrdiff_t(size);
+        std::sort(middle, _indices.end());
+        std::inplace_merge(_indices.begin(), middle, _indices.end());
+    }
+    template <class Predicate>
+    size_type filter(Predicate&& predicate) {
+        size_type kept = 0;
+        for (const index_type index: _indices) {
+            if (predicate(index)) {
+                _indices[kept++] = index;
+            } else {
+                const word_type bit = word_type(1) << (index % word_bits);
+                _words[index / word_bits].fetch_and(
+                    ~bit,
+                    std::memory_order_relaxed
+                );
+            }
+        }
+        const size_type result = _indices.size() - kept;
+        _indices.resize(kept);
+        return result;
+    }
+
+    // Access
+    public:
+    const index_container_type& indices() const noexcept {
+        return _indices;
+    }
+    const_iterator begin() const noexcept {
+        return _indices.begin();
+    }
+    const_iterator end() const noexcept {
+        return _indices.end();
+    }
+    index_type operator[](size_type i) const noexcept {
+        return _indices[i];
+    }
+
+    // Implementation details
+    private:
+    std::unique_ptr<std::atomic<word_type>[]> _words;
+    index_container_type _indices;
+    std::vector<index_container_type> _pending;
+    size_type _universe = 0;
+};
+// ========================================================================== //
+
+
+
+// ========================== INFECTION PROPOSALS =========================== //
+// An attempt of a source to infect a target, at a time within the tick
+struct infection {
+    std::uint32_t target;
+    std::uint32_t source;
+    float time;
+};
+
+// Proposals of infections gathered without synchronization in buffers owned
+// by the workers of an executor, each growing in its own arena which is reset
+// and reused at each tick, so that memory is bounded by the number of workers
+// and stops being allocated once the largest tick has been seen. Proposals
+// are resolved by bucketing them by target, with the offsets of the buckets
+// computed by a parallel prefix over the buckets and the workers, and by
+// sorting each bucket, so that the earliest proposal of each target wins, with
+// ties broken by source, independently of the number of threads
+class infection_proposals
+{
+    // Types
+    public:
+    using value_type = infection;
+    using index_type = std::uint32_t;
+    using size_type = std::size_t;
+    using arena_type = monotonic_arena;
+    using allocator_type = arena_allocator<value_type>;
+    using buffer_type = std::vector<value_type, allocator_type>;
+    using container_type = std::vector<value_type>;
+
+    // Constants
+    public:
+    static constexpr size_type buckets_per_thread = 4;
+
+    // Capacity
+    public:
+    bool empty() const noexcept {
+        return size() == 0;
+    }
+    size_type size() const noexcept {
+        size_type result = 0;
+        for (const buffer_type& buffer: _buffers) {
+            result += buffer.size();
+        }
+        return result;
+    }
+    size_type buffers() const noexcept {
+        return _buffers.size();
+    }
+    void prepare(size_type workers) {
+        const size_type count = std::max(workers, size_type(1));
+        while (_arenas.size() < count) {
+            _arenas.emplace_back();
+            _buffers.emplace_back(allocator_type(_arenas.back()));
+        }
+        for (size_type i = 0; i < _buffers.size(); ++i) {
+            _buffers[i] = buffer_type(allocator_type(_arenas[i]));
+            _arenas[i].reset();
+        }
+        _count = count;
+    }
+
+    // Access
+    public:
+    buffer_type& buffer(size_type i) noexcept {
+        return _buffers[i];
+    }
+    const buffer_type& buffer(size_type i) const noexcept {
+        return _buffers[i];
+    }
+
+    // Resolution
+    public:
+    template <class Executor>
+    size_type resolve(
+        Executor& executor,
+        size_type universe,
+        container_type& winners
+    ) {
+        const size_type buckets = std::max(
+            executor.size() * buckets_per_thread,
+            size_type(1)
+        );
+        const size_type extent = std::max(universe, size_type(1));
+        const auto bucket = [=](index_type target) noexcept {
+            return static_cast<size_type>(
+                std::uint64_t(target) * buckets / extent
+            );
+        };
+        _offsets.assign(_count * buckets, 0);
+        _totals.assign(buckets + 1, 0);
+        executor.parallel_for(0, _count, 1, [&](size_type i) {
+            for (const value_type& proposal: _buffers[i]) {
+                ++_offsets[bucket(proposal.target) * _count + i];
+            }
+        });
+        executor.parallel_for(0, buckets, 1, [&](size_type b) {
+            size_type total = 0;
+            for (size_type i = b * _count; i < (b + 1) * _count; ++i) {
+                total += std::exchange(_offsets[i], total);
+            }
+            _totals[b + 1] = total;
+        });
+        for (size_type b = 0; b < buckets; ++b) {
+            _totals[b + 1] += _totals[b];
+        }
+        executor.parallel_for(0, buckets, 1, [&](size_type b) {
+            for (size_type i = b * _count; i < (b + 1) * _count; ++i) {
+                _offsets[i] += _totals[b];
+            }
+        });
+        _proposals.resize(_totals.back());
+        executor.parallel_for(0, _count, 1, [&](size_type i) {
+            for (const value_type& proposal: _buffers[i]) {
+                const size_type b = bucket(proposal.target);
+                _proposals[_offsets[b * _count + i]++] = proposal;
+            }
+        });
+        _wins.assign(buckets, 0);
+        executor.parallel_for(0, buckets, 1, [&](size_type b) {
+            const auto first = _proposals.begin() + _totals[b];
+            const auto last = _proposals.begin() + _totals[b + 1];
+            std::sort(first, last, [](
+                const value_type& lhs,
+                const value_type& rhs
+            ) {
+                return lhs.target != rhs.target ? lhs.target < rhs.target
+                : lhs.time != rhs.time ? lhs.time < rhs.time
+                : lhs.source < rhs.source;
+            });
+            auto output = first;
+            for (auto it = first; it != last; ++it) {
+                if (it == first || it->target != (it - 1)->target) {
+                    *output++ = *it;
+                }
+            }
+            _wins[b] = static_cast<size_type>(output - first);
+        });
+        winners.clear();
+        for (size_type b = 0; b < buckets; ++b) {
+            const auto first = _proposals.begin() + _totals[b];
+            winners.insert(winners.end(), first, first + _wins[b]);
+        }
+        return winners.size();
+    }
+
+    // Implementation details
+    private:
+    std::deque<arena_type> _arenas;
+    std::vector<buffer_type> _buffers;
+    std::vector<size_type> _offsets;
+    std::vector<size_type> _totals;
+    std::vector<size_type> _wins;
+    container_type _proposals;
+    size_type _count = 0;
+};
+// ========================================================================== //
+
+
+
+// ========================== FRONTIER TRANSMISSION ========================= //
+// A transmission kernel driven by the frontier of infectious agents, in the
+// style of direction-optimizing breadth first searches: while the frontier
+// is sparse, infectious agents push infection attempts along their edges, so
+// that a tick costs the number of edges leaving the frontier, and once the
+// frontier passes a density threshold, susceptible agents pull from their
+// neighbors by testing the bitmap of the frontier, which avoids scattered
+// writes when most agents are reached anyway. The outcome of an attempt
+// along an edge is a pure function of the generator, of the layer of the edge
+// and of both its ends, so that both directions produce the same infections
+// on symmetric layers regardless of the number of threads. Pulling reads the
+// edges leaving each susceptible agent as the edges reaching it, which only
+// holds on layers assigned symmetrically: directed layers are always pushed,
+// even during the steps pulling along the symmetric ones. The attempts of a
+// layer are drawn on the stream of the generator offset by the index of the
+// layer, so that a kernel uses as many consecutive streams as the graph has
+// layers, and contacts in several layers are independent trials, while
+// parallel edges of a layer share their draw. Infections are either added to
+// a frontier, which is never cleared by the kernel so that the kernels of
+// several layers accumulate in it until the caller clears it for the next
+// tick, its list being gathered from the agents marked by each worker after
+// a push and collected from its bitmap after a pull, or gathered as proposals
+// whose resolution also tells the source and the time of each infection.
+// Steps return the number of new infections
+template <class Graph, class Bijection = philox4x32>
+class frontier_transmission
+{
+    // Types
+    public:
+    using graph_type = Graph;
+    using rng_type = counter_based_rng<Bijection>;
+    using index_type = typename graph_type::index_type;
+    using size_type = std::size_t;
+    using frontier_type = agent_frontier;
+    using proposals_type = infection_proposals;
+    using infections_type = typename proposals_type::container_type;
+
+    // Constants
+    public:
+    static constexpr size_type all_layers = std::numeric_limits<
+        size_type
+    >::max();
+    static constexpr double default_density = 0.05;
+    static constexpr size_type push_chunk = 64;
+    static constexpr size_type pull_chunk = 1024;
+
+    // Lifecycle
+    public:
+    frontier_transmission(
+        const graph_type& graph,
+        double probability,
+        size_type layer = all_layers,
+        double density = default_density
+    ) noexcept
+    : _graph(&graph)
+    , _probability(probability)
+    , _threshold(sampler_kernels::threshold(probability))
+    , _layer(layer)
+    , _density(density) {
+    }
+
+    // Access
+    public:
+    const graph_type& graph() const noexcept {
+        return *_graph;
+    }
+    double probability() const noexcept {
+        return _probability;
+    }
+    size_type layer() const noexcept {
+        return _layer;
+    }
+    double density() const noexcept {
+        return _density;
+    }
+    size_type pushes() const noexcept {
+        return _pushes;
+    }
+    size_type pulls() const noexcept {
+        return _pulls;
+    }
+
+    // Transmission
+    public:
+    bool pulling(const frontier_type& infectious) const noexcept {
+        bool pullable = false;
+        for (size_type layer = 0; layer < graph_type::layers; ++layer) {
+            pullable = pullable || _pulled(layer);
+        }
+        return pullable && infectious.density() > _density;
+    }
+    template <class States, class Code>
+    size_type step(
+        const States& states,
+        Code susceptible,
+        const frontier_type& infectious,
+        const rng_type& rng,
+        frontier_type& infected
+    ) {
+        sequential_executor executor;
+        return step(executor, states, susceptible, infectious, rng, infected);
+    }
+    template <class Executor, class States, class Code>
+    size_type step(
+        Executor& executor,
+        const States& states,
+        Code susceptible,
+        const frontier_type& infectious,
+        const rng_type& rng,
+        frontier_type& infected
+    ) {
+        const size_type before = infected.size();
+        const bool pull = pulling(infectious);
+        infected.prepare(executor.size());
+        if (pull) {
+            ++_pulls;
+            _pull(executor, states, susceptible, infectious, rng, infected);
+        }
+        if (_pushing(pull)) {
+            ++_pushes;
+            _push(
+                executor, states, susceptible, infectious, rng, pull, infected
+            );
+        }
+        if (pull) {
+            infected.collect();
+        } else {
+            infected.gather();
+        }
+        return infected.size() - before;
+    }
+    template <class States, class Code>
+    size_type step(
+        const States& states,
+        Code susceptible,
+        const frontier_type& infectious,
+        const rng_type& rng,
+        proposals_type& proposals,
+        infections_type& infections
+    ) {
+        sequential_executor executor;
+        return step(
+            executor,
+            states,
+            susceptible,
+            infectious,
+            rng,
+            proposals,
+            infections
+        );
+    }
+    template <class Executor, class States, class Code>
+    size_type step(
+        Executor& executor,
+        const States& states,
+        Code susceptible,
+        const frontier_type& infectious,
+        const rng_type& rng,
+        proposals_type& proposals,
+        infections_type& infections
+    ) {
+        const bool pull = pulling(infectious);
+        proposals.prepare(executor.size());
+        if (pull) {
+            ++_pulls;
+            _pull(executor, states, susceptible, infectious, rng, proposals);
+        }
+        if (_pushing(pull)) {
+            ++_pushes;
+            _push(
+                executor, states, susceptible, infectious, rng, pull, proposals
+            );
+        }
+        return proposals.resolve(executor, _graph->vertices(), infections);
+    }
+
+    // Implementation details
+    private:
+    bool _selected(size_type layer) const noexcept {
+        return _layer == all_layers || _layer == layer;
+    }
+    bool _pulled(size_type layer) const noexcept {
+        return _selected(layer)
+        && _graph->symmetric(layer)
+        && _graph->edges(layer) > 0;
+    }
+    bool _pushed(size_type layer, bool pull) const noexcept {
+        return _selected(layer) && !(pull && _pulled(layer));
+    }
+    bool _pushing(bool pull) const noexcept {
+        bool result = false;
+        for (size_type layer = 0; layer < graph_type::layers; ++layer) {
+            result = result || _pushed(layer, pull);
+        }
+        return result;
+    }
+    static rng_type _generator(const rng_type& rng, size_type layer) noexcept {
+        using stream_type = typename rng_type::index_type;
+        return rng.with(rng.stream() + static_cast<stream_type>(layer));
+    }
+    template <class Edge>
+    std::uint64_t _limit(const Edge& edge) const noexcept {
+        if constexpr (graph_type::weighted) {
+            return sampler_kernels::threshold(
+                _probability * static_cast<double>(edge.weight)
+            );
+        } else {
+            return _threshold;
+        }
+    }
+    template <class Edge>
+    bool _transmits(
+        const rng_type& rng,
+        index_type source,
+        index_type target,
+        const Edge& edge
+    ) const noexcept {
+        return rng.bits(target, source) < _limit(edge);
+    }
+    template <class Edge>
+    bool _propose(
+        const rng_type& rng,
+        index_type source,
+        index_type target,
+        const Edge& edge,
+        infection& proposal
+    ) const noexcept {
+        const std::uint64_t limit = _limit(edge);
+        const std::uint64_t bits = rng.bits(target, source);
+        proposal = {target, source, static_cast<float>(
+            static_cast<double>(bits) / static_cast<double>(limit)
+        )};
+        return bits < limit;
+    }
+    template <class Executor, class States, class Code>
+    void _push(
+        Executor& executor,
+        const States& states,
+        Code susceptible,
+        const frontier_type& infectious,
+        const rng_type& rng,
+        bool pull,
+        frontier_type& infected
+    ) const {
+        const size_type size = infectious.size();
+        executor.parallel_for(0, size, push_chunk, [&](size_type i) {
+            const size_type worker = executor.worker();
+            const index_type source = infectious[i];
+            for (size_type layer = 0; layer < graph_type::layers; ++layer) {
+                if (!_pushed(layer, pull)) {
+                    continue;
+                }
+                const rng_type generator = _generator(rng, layer);
+                for (const auto& edge: _graph->neighbors(layer, source)) {
+                    const index_type target = edge.target;
+                    if (states[target] == susceptible
+                        && !infected.contains(target)
+                        && _transmits(generator, source, target, edge)) {
+                        infected.mark(target, worker);
+                    }
+                }
+            }
+        });
+    }
+    template <class Executor, class States, class Code>
+    void _pull(
+        Executor& executor,
+        const States& states,
+        Code susceptible,
+        const frontier_type& infectious,
+        const rng_type& rng,
+        frontier_type& infected
+    ) const {
+        const size_type size = _graph->vertices();
+        executor.parallel_for(0, size, pull_chunk, [&](size_type i) {
+            const index_type target = static_cast<index_type>(i);
+            if (!(states[target] == susceptible)) {
+                return;
+            }
+            for (size_type layer = 0; layer < graph_type::layers; ++layer) {
+                if (!_pulled(layer)) {
+                    continue;
+                }
+                const rng_type generator = _generator(rng, layer);
+                for (const auto& edge: _graph->neighbors(layer, target)) {
+                    const index_type source = edge.target;
+                    if (infectious.contains(source)
+                        && _transmits(generator, source, target, edge)) {
+                        infected.mark(target);
+                        return;
+                    }
+                }
+            }
+        });
+    }
+    template <class Executor, class States, class Code>
+    void _push(
+        Executor& executor,
+        const States& states,
+        Code susceptible,
+        const frontier_type& infectious,
+        const rng_type& rng,
+        bool pull,
+        proposals_type& proposals
+    ) const {
+        const size_type size = infectious.size();
+        const size_type chunks = (size + push_chunk - 1) / push_chunk;
+        executor.parallel_for(0, chunks, 1, [&](size_type chunk) {
+            auto& buffer = proposals.buffer(executor.worker());
+            const size_type last = std::min(size, (chunk + 1) * push_chunk);
+            infection proposal = {};
+            for (size_type i = chunk * push_chunk; i < last; ++i) {
+                const index_type source = infectious[i];
+                for (size_type layer = 0; layer < graph_type::layers; ++layer) {
+                    if (!_pushed(layer, pull)) {
+                        continue;
+                    }
+                    const rng_type generator = _generator(rng, layer);
+                    for (const auto& edge: _graph->neighbors(layer, source)) {
+                        const index_type target = edge.target;
+                        if (states[target] == susceptible && _propose(
+                            generator, source, target, edge, proposal
+                        )) {
+                            buffer.push_back(proposal);
+                        }
+                    }
+                }
+            }
+        });
+    }
+    template <class Executor, class States, class Code>
+    void _pull(
+        Executor& executor,
+        const States& states,
+        Code susceptible,
+        const frontier_type& infectious,
+        const rng_type& rng,
+        proposals_type& proposals
+    ) const {
+        const size_type size = _graph->vertices();
+        const size_type chunks = (size + pull_chunk - 1) / pull_chunk;
+        executor.parallel_for(0, chunks, 1, [&](size_type chunk) {
+            auto& buffer = proposals.buffer(executor.worker());
+            const size_type last = std::min(size, (chunk + 1) * pull_chunk);
+            infection proposal = {};
+            for (size_type i = chunk * pull_chunk; i < last; ++i) {
+                const index_type target = static_cast<index_type>(i);
+                if (!(states[target] == susceptible)) {
+                    continue;
+                }
+                infection winner = {target, 0, 2.f};
+                for (size_type layer = 0; layer < graph_type::layers; ++layer) {
+                    if (!_pulled(layer)) {
+                        continue;
+                    }
+                    const rng_type generator = _generator(rng, layer);
+                    for (const auto& edge: _graph->neighbors(layer, target)) {
+                        const index_type source = edge.target;
+                        const bool proposed = infectious.contains(source)
+                        && _propose(generator, source, target, edge, proposal);
+                        if (proposed && (proposal.time < winner.time
+                            || (proposal.time == winner.time
+                            && proposal.source < winner.source))) {
+                            winner = proposal;
+                        }
+                    }
+                }
+                if (winner.time < 2.f) {
+                    buffer.push_back(winner);
+                }
+            }
+        });
+    }
+    const graph_type* _graph;
+    double _probability;
+    std::uint64_t _threshold;
+    size_type _layer;
+    double _density;
+    size_type _pushes = 0;
+    size_type _pulls = 0;
+};
+// ========================================================================== //
+
+
+
+// ========================== LOCATION TRANSMISSION ========================= //
+// A transmission kernel for well-mixed locations such as households,
+// classrooms or offices: the infectiousness of the agents of each location is
+// summed in a single pass over its bucket, and each susceptible agent of the
+// location is then infected with the probability given by the resulting
+// force of infection, so that a location costs its occupancy instead of its
+// number of pairs. The force is divided by the number of other agents in the
+// location when transmission is frequency dependent. Each contact layer is
+// either handled pairwise by a frontier transmission restricted to it, or by
+// a location transmission over the buckets of its activity: both kernels add
+// their infections to the given frontier without clearing it, in any order,
+// so that the frontier of a tick is the union of the infections of all the
+// layers, and draws are keyed by agent on the stream of the generator, which
+// should differ from the streams of the other kernels, frontier transmissions
+// using one stream per layer of their graph
+template <class Bijection = philox4x32>
+class location_transmission
+{
+    // Types
+    public:
+    using rng_type = counter_based_rng<Bijection>;
+    using index_type = std::uint32_t;
+    using size_type = std::size_t;
+    using buckets_type = location_buckets;
+    using frontier_type = agent_frontier;
+
+    // Lifecycle
+    public:
+    explicit location_transmission(
+        double rate,
+        bool frequency_dependent = true
+    ) noexcept
+    : _rate(rate), _frequency_dependent(frequency_dependent) {
+    }
+
+    // Access
+    public:
+    double rate() const noexcept {
+        return _rate;
+    }
+    bool frequency_dependent() const noexcept {
+        return _frequency_dependent;
+    }
+
+    // Transmission
+    public:
+    template <class Infectiousness, class States, class Code>
+    size_type step(
+        const buckets_type& buckets,
+        const Infectiousness& infectiousness,
+        const States& states,
+        Code susceptible,
+        const rng_type& rng,
+        frontier_type& infected
+    ) const {
+        sequential_executor executor;
+        return step(
+            executor,
+            buckets,
+            infectiousness,
+            states,
+            susceptible,
+            rng,
+            infected
+        );
+    }
+    template <class Executor, class Infectiousness, class States, class Code>
+    size_type step(
+        Executor& executor,
+        const buckets_type& buckets,
+        const Infectiousness& infectiousness,
+        const States& states,
+        Code susceptible,
+        const rng_type& rng,
+        frontier_type& infected
+    ) const {
+        const size_type before = infected.size();
+        infected.prepare(executor.size());
+        const auto kernel = [&](size_type location, auto agents) {
+            const size_type occupancy = buckets.occupancy(location);
+            double total = 0;
+            for (const index_type agent: agents) {
+                total += _infectiousness(infectiousness, agent);
+            }
+            if (occupancy < 2 || !(total > 0)) {
+                return;
+            }
+            const double contacts = _frequency_dependent
+            ? static_cast<double>(occupancy - 1)
+            : 1.;
+            const std::uint64_t threshold = sampler_kernels::threshold(
+                -std::expm1(-_rate * total / contacts)
+            );
+            for (const index_type agent: agents) {
+                if (states[agent] == susceptible
+                    && rng.bits(agent) < threshold) {
+                    infected.mark(agent, executor.worker());
+                }
+            }
+        };
+        buckets.for_each_location(executor, kernel);
+        infected.gather();
+        return infected.size() - before;
+    }
+
+    // Implementation details
+    private:
+    template <class Infectiousness>
+    static double _infectiousness(
+        const Infectiousness& infectiousness,
+        index_type agent
+    ) {
+        if constexpr (std::is_invocable_v<const Infectiousness&, index_type>) {
+            return static_cast<double>(infectiousness(agent));
+        } else {
+            return static_cast<double>(infectiousness[agent]);
+        }
+    }
+    double _rate;
+    bool _frequency_dependent;
+};
+// ========================================================================== //
+
+
+
+// ========================================================================== //
+} // namespace epidesim
+#endif // _TRANSMISSION_HPP_INCLUDED
+// ========================================================================== //
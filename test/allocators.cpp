@@ -0,0 +1,201 @@
+// =============================== ALLOCATORS =============================== //
+// Project:         epidesim
+// Name:            allocators.cpp
+// Description:     Tests of the allocators and memory resources
+// Creator:         Vincent Reverdy
+// Contributor(s):  Vincent Reverdy [2020-]
+// License:         BSD 3-Clause License
+// ========================================================================== //
+
+
+
+// ============================== PREAMBLE ================================== //
+// C++ standard library
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <type_traits>
+// Project sources
+#include "allocators.hpp"
+#include "parallel.hpp"
+#include "testing.hpp"
+// Third-party libraries
+// Miscellaneous
+using namespace epidesim;
+// ========================================================================== //
+
+
+
+// ============================ MONOTONIC ARENA ============================= //
+// Checks that arenas align, grow and rewind without releasing their blocks
+void test_monotonic_arena() {
+    monotonic_arena arena(1024);
+    EPIDESIM_CHECK(arena.used() == 0 && arena.capacity() == 0);
+    void* first = arena.allocate(10);
+    void* second = arena.allocate(8, 64);
+    EPIDESIM_CHECK(reinterpret_cast<std::uintptr_t>(first) % 16 == 0);
+    EPIDESIM_CHECK(reinterpret_cast<std::uintptr_t>(second) % 64 == 0);
+    EPIDESIM_CHECK(static_cast<std::byte*>(second) >= static_cast<std::byte*>(
+        first
+    ) + 10);
+    EPIDESIM_CHECK(arena.used() >= 18 && arena.capacity() == 1024);
+    for (int i = 0; i < 100; ++i) {
+        arena.allocate(100);
+    }
+    void* large = arena.allocate(100000);
+    EPIDESIM_CHECK(large != nullptr && arena.capacity() >= 100000 + 10000);
+    const std::size_t capacity = arena.capacity();
+    arena.reset();
+    EPIDESIM_CHECK(arena.used() == 0 && arena.capacity() == capacity);
+    EPIDESIM_CHECK(arena.allocate(10) == first);
+    for (int i = 0; i < 100; ++i) {
+        arena.allocate(100);
+    }
+    EPIDESIM_CHECK(arena.capacity() == capacity);
+    arena.retire();
+    EPIDESIM_CHECK(arena.allocate(10) != first);
+    EPIDESIM_CHECK(arena.capacity() > capacity);
+    arena.release();
+    EPIDESIM_CHECK(arena.used() == 0 && arena.capacity() == 0);
+}
+// ========================================================================== //
+
+
+
+// ============================== POOL RESOURCE ============================= //
+// Checks that pools recycle blocks per size class
+void test_pool_resource() {
+    pool_resource pool;
+    void* small = pool.allocate(24);
+    void* other = pool.allocate(32);
+    EPIDESIM_CHECK(small != other);
+    pool.deallocate(small, 24);
+    EPIDESIM_CHECK(pool.allocate(20) == small);
+    pool.deallocate(other, 32);
+    EPIDESIM_CHECK(pool.allocate(17) == other);
+    EPIDESIM_CHECK(pool.allocate(8) != other);
+    void* large = pool.allocate(pool_resource::max_block_size + 1);
+    EPIDESIM_CHECK(large != nullptr);
+    pool.deallocate(large, pool_resource::max_block_size + 1);
+    const std::size_t capacity = pool.capacity();
+    pool.reset();
+    EPIDESIM_CHECK(pool.capacity() == capacity);
+    pool.release();
+    EPIDESIM_CHECK(pool.capacity() == 0);
+}
+// ========================================================================== //
+
+
+
+// =========================== RESOURCE ALLOCATOR =========================== //
+// Checks that containers allocate from the resources of their allocators
+void test_resource_allocator() {
+    static_assert(is_allocator_v<arena_allocator<int>>);
+    static_assert(is_allocator_v<pool_allocator<double>>);
+    static_assert(std::is_same_v<
+        rebind_container_t<std::vector<int, arena_allocator<int>>, char>,
+        std::vector<char, arena_allocator<char>>
+    >);
+    monotonic_arena arena;
+    pool_resource pool;
+    std::vector<int, arena_allocator<int>> values{arena_allocator<int>(arena)};
+    for (int i = 0; i < 1000; ++i) {
+        values.push_back(i);
+    }
+    EPIDESIM_CHECK(values.back() == 999 && arena.used() >= 1000 * sizeof(int));
+    EPIDESIM_CHECK(values.get_allocator().resource() == &arena);
+    const arena_allocator<char> rebound = values.get_allocator();
+    EPIDESIM_CHECK(rebound == values.get_allocator());
+    EPIDESIM_CHECK(arena_allocator<int>() != values.get_allocator());
+    EPIDESIM_CHECK(arena_allocator<int>().resource() == &(
+        monotonic_arena::default_resource()
+    ));
+    std::vector<double, pool_allocator<double>> pooled{
+        pool_allocator<double>(pool)
+    };
+    pooled.assign(10, 1.);
+    const double* data = pooled.data();
+    pooled = std::vector<double, pool_allocator<double>>(
+        10,
+        2.,
+        pool_allocator<double>(pool)
+    );
+    EPIDESIM_CHECK(pooled.data() != data && pooled[9] == 2.);
+    EPIDESIM_CHECK(pool.allocate(10 * sizeof(double)) == data);
+}
+// ========================================================================== //
+
+
+
+// ============================== NUMA MEMORY =============================== //
+// Checks that mapping leaves pages untouched for first touch to place them
+void test_first_touch() {
+    thread_pool pool(4);
+    numa_counters& counters = numa_counters::global();
+    const std::size_t page = numa_memory::page_size();
+    const std::size_t bytes = 64 * page + 100;
+    counters.reset();
+    void* mapped = numa_memory::map(bytes);
+    EPIDESIM_CHECK(mapped != nullptr && counters.nodes() == 0);
+    first_touch(pool, mapped, bytes);
+    std::size_t placed = 0;
+    for (std::size_t node = 0; node < counters.nodes(); ++node) {
+        placed += counters.bytes(node);
+    }
+    EPIDESIM_CHECK(placed == bytes);
+    EPIDESIM_CHECK(counters.placement_rate(numa_node()) >= 0);
+    numa_memory::deallocate(mapped, bytes);
+    counters.reset();
+    std::byte* data = static_cast<std::byte*>(first_touch(pool, bytes));
+    data[bytes - 1] = std::byte(1);
+    EPIDESIM_CHECK(counters.nodes() > 0);
+    numa_memory::deallocate(data, bytes);
+    counters.reset();
+    void* block = numa_memory::allocate(page);
+    EPIDESIM_CHECK(counters.bytes(numa_node()) == page);
+    numa_memory::deallocate(block, page);
+}
+
+// Checks that default numa arenas outlive the threads allocating from them,
+// and start a fresh block when they are handed over to another thread
+void test_numa_allocator() {
+    using vector_type = std::vector<int, numa_allocator<int>>;
+    vector_type values;
+    const numa_arena* leased = nullptr;
+    std::thread worker([&] {
+        leased = &numa_arena::default_resource();
+        values = vector_type(100000, 7);
+        values.reserve(100001);
+    });
+    worker.join();
+    EPIDESIM_CHECK(values.get_allocator().resource() == leased);
+    EPIDESIM_CHECK(values.size() == 100000 && values.back() == 7);
+    const numa_arena* reused = nullptr;
+    const std::size_t capacity = leased->capacity();
+    std::thread successor([&] {
+        reused = &numa_arena::default_resource();
+        vector_type others(1000, 3);
+        EPIDESIM_CHECK(reused->capacity() > capacity);
+        EPIDESIM_CHECK(others.data() < values.data() || others.data() > &(
+            values.back()
+        ));
+    });
+    successor.join();
+    EPIDESIM_CHECK(reused == leased && values.back() == 7);
+    EPIDESIM_CHECK(&numa_arena::default_resource() != leased);
+}
+// ========================================================================== //
+
+
+
+// ================================== MAIN ================================== //
+// Runs the tests
+int main() {
+    test_monotonic_arena();
+    test_pool_resource();
+    test_resource_allocator();
+    test_first_touch();
+    test_numa_allocator();
+    return test_result();
+}
+// ========================================================================== //
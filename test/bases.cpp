@@ -0,0 +1,318 @@
+// ================================== BASES ================================= //
+// Project:         epidesim
+// Name:            bases.cpp
+// Description:     Tests of the generic bases
+// Creator:         Vincent Reverdy
+// Contributor(s):  Vincent Reverdy [2020-]
+// License:         BSD 3-Clause License
+// ========================================================================== //
+
+
+
+// ============================== PREAMBLE ================================== //
+// C++ standard library
+#include <random>
+#include <vector>
+#include <cstdint>
+#include <utility>
+// Project sources
+#include "bases.hpp"
+#include "parallel.hpp"
+#include "testing.hpp"
+// Third-party libraries
+// Miscellaneous
+using namespace epidesim;
+// ========================================================================== //
+
+
+
+// ================================== TREE ================================== //
+// Checks the links of a tree built node by node
+void test_tree() {
+    using tree_type = tree<int>;
+    constexpr tree_type::index_type npos = tree_type::npos;
+    static_assert(sizeof(tree_type::node) == 4 * sizeof(std::uint32_t));
+    tree_type empty;
+    EPIDESIM_CHECK(empty.empty() && empty.size() == 0);
+    tree_type t(std::in_place, 1);
+    const auto a = t.emplace_child(t.root(), 2);
+    const auto b = t.emplace_child(t.root(), 3);
+    const auto c = t.emplace_child(a, 4);
+    const auto d = t.emplace_child(a, 5);
+    EPIDESIM_CHECK(t.size() == 5 && !t.empty());
+    EPIDESIM_CHECK(t.is_root(t.root()) && !t.is_root(a));
+    EPIDESIM_CHECK(t.parent(a) == t.root() && t.parent(c) == a);
+    EPIDESIM_CHECK(t.parent(t.root()) == npos);
+    EPIDESIM_CHECK(t.first_child(t.root()) == a && t.last_child(t.root()) == b);
+    EPIDESIM_CHECK(t.next_sibling(a) == b && t.next_sibling(b) == npos);
+    EPIDESIM_CHECK(t.first_child(a) == c && t.next_sibling(c) == d);
+    EPIDESIM_CHECK(t.is_leaf(b) && t.is_leaf(d) && !t.is_leaf(a));
+    EPIDESIM_CHECK(t.degree(t.root()) == 2 && t.degree(a) == 2);
+    EPIDESIM_CHECK(t.degree(b) == 0);
+    EPIDESIM_CHECK(t[t.root()] == 1 && t[b] == 3 && t[d] == 5);
+    t[c] = 40;
+    EPIDESIM_CHECK(t.values() == std::vector<int>({1, 2, 3, 40, 5}));
+    EPIDESIM_CHECK(t.nodes()[c].parent() == a);
+    tree_type copy = t;
+    EPIDESIM_CHECK(copy.first_child(copy.first_child(copy.root())) == c);
+    t.clear();
+    EPIDESIM_CHECK(t.empty());
+}
+// ========================================================================== //
+
+
+
+// ============================= TREE TRAVERSALS ============================ //
+// Builds a random tree of the given size, each node being its own value
+tree<int> make_random_tree(std::size_t size, unsigned int seed) {
+    std::mt19937 engine(seed);
+    tree<int> result(std::in_place, 0);
+    for (std::size_t i = 1; i < size; ++i) {
+        std::uniform_int_distribution<std::size_t> parent(0, i - 1);
+        result.emplace_child(parent(engine) / 2, static_cast<int>(i));
+    }
+    return result;
+}
+
+// Lists the values visited by a traversal from a node
+template <class Traversal, class Tree>
+std::vector<int> traverse(const Tree& t, typename Tree::index_type origin) {
+    std::vector<int> result;
+    for (const int value: t.template range<Traversal>(origin)) {
+        result.push_back(value);
+    }
+    return result;
+}
+
+// Lists the values of a subtree in depth first order, after N children
+template <class Tree>
+void visit(
+    const Tree& t,
+    typename Tree::index_type index,
+    std::size_t n,
+    std::vector<int>& result
+) {
+    std::size_t count = 0;
+    auto child = t.first_child(index);
+    for (; child != Tree::npos && count < n; ++count) {
+        visit(t, child, n, result);
+        child = t.next_sibling(child);
+    }
+    result.push_back(t[index]);
+    for (; child != Tree::npos; child = t.next_sibling(child)) {
+        visit(t, child, n, result);
+    }
+}
+
+// Checks all the traversals against recursive and queue-based references
+void test_tree_traversals() {
+    using tree_type = tree<int>;
+    using index_type = tree_type::index_type;
+    constexpr index_type npos = tree_type::npos;
+    for (unsigned int seed = 0; seed < 8; ++seed) {
+        const tree_type t = make_random_tree(1 + seed * 37, seed);
+        const index_type size = static_cast<index_type>(t.size());
+        for (index_type origin = 0; origin < size; ++origin) {
+            std::vector<int> expected;
+            for (auto i = t.first_child(origin); i != npos;) {
+                expected.push_back(t[i]);
+                i = t.next_sibling(i);
+            }
+            EPIDESIM_CHECK(traverse<children>(t, origin) == expected);
+            expected.clear();
+            for (auto i = t.parent(origin); i != npos; i = t.parent(i)) {
+                expected.push_back(t[i]);
+            }
+            EPIDESIM_CHECK(traverse<ancestors>(t, origin) == expected);
+            expected.clear();
+            if (!t.is_root(origin)) {
+                auto i = t.first_child(t.parent(origin));
+                for (; i != npos; i = t.next_sibling(i)) {
+                    if (i != origin) {
+                        expected.push_back(t[i]);
+                    }
+                }
+            }
+            EPIDESIM_CHECK(traverse<siblings>(t, origin) == expected);
+            expected.clear();
+            visit(t, origin, 0, expected);
+            EPIDESIM_CHECK(traverse<preorder_dfs>(t, origin) == expected);
+            expected.clear();
+            visit(t, origin, 1, expected);
+            EPIDESIM_CHECK(traverse<inorder_dfs<1>>(t, origin) == expected);
+            expected.clear();
+            visit(t, origin, 2, expected);
+            EPIDESIM_CHECK(traverse<inorder_dfs<2>>(t, origin) == expected);
+            expected.clear();
+            visit(t, origin, size, expected);
+            EPIDESIM_CHECK(traverse<postorder_dfs>(t, origin) == expected);
+            expected.clear();
+            std::vector<index_type> queue(1, origin);
+            for (std::size_t head = 0; head < queue.size(); ++head) {
+                expected.push_back(t[queue[head]]);
+                auto i = t.first_child(queue[head]);
+                for (; i != npos; i = t.next_sibling(i)) {
+                    queue.push_back(i);
+                }
+            }
+            const auto bfs = traverse<breadth_first_search>(t, origin);
+            EPIDESIM_CHECK(bfs == expected);
+        }
+    }
+    tree_type t = make_random_tree(16, 42);
+    for (int& value: t.range<preorder_dfs>()) {
+        value *= 2;
+    }
+    auto it = t.begin<preorder_dfs>();
+    EPIDESIM_CHECK(*it == 0 && it.index() == t.root());
+    EPIDESIM_CHECK(*++it == 2 * static_cast<int>(t.first_child(t.root())));
+    tree_type::const_iterator<preorder_dfs> converted = it;
+    EPIDESIM_CHECK(converted.index() == it.index());
+    EPIDESIM_CHECK(t.range<preorder_dfs>(t.size()).empty());
+}
+// ========================================================================== //
+
+
+
+// ============================ TREE LINEARIZATION ========================== //
+// Checks that linearized trees are stored in pre-order with contiguous
+// subtrees
+void test_tree_linearization() {
+    using tree_type = tree<int>;
+    using index_type = tree_type::index_type;
+    tree_type t = make_random_tree(200, 7);
+    const tree_type former = t;
+    const std::vector<int> preorder = traverse<preorder_dfs>(t, t.root());
+    EPIDESIM_CHECK(!t.is_linearized());
+    const auto indices = t.linearize();
+    EPIDESIM_CHECK(t.is_linearized());
+    EPIDESIM_CHECK(t.values() == preorder);
+    EPIDESIM_CHECK(traverse<preorder_dfs>(t, t.root()) == preorder);
+    for (index_type i = 0; i < former.size(); ++i) {
+        EPIDESIM_CHECK(t[indices[i]] == former[i]);
+        if (!former.is_root(i)) {
+            EPIDESIM_CHECK(t.parent(indices[i]) == indices[former.parent(i)]);
+            EPIDESIM_CHECK(t.parent(indices[i]) < indices[i]);
+        }
+    }
+    for (index_type i = 0; i < t.size(); ++i) {
+        const auto range = t.subtree_range(i);
+        const std::vector<int> subtree(range.begin(), range.end());
+        EPIDESIM_CHECK(subtree == traverse<preorder_dfs>(t, i));
+        EPIDESIM_CHECK(t.subtree_size(i) == subtree.size());
+    }
+    t.emplace_child(t.root(), -1);
+    EPIDESIM_CHECK(!t.is_linearized());
+}
+// ========================================================================== //
+
+
+
+// ============================ TREE REDUCTIONS ============================= //
+// Computes the sums of the values of all subtrees by brute force
+std::vector<long> subtree_sums(tree<int>& t) {
+    std::vector<long> result(t.size());
+    for (std::size_t i = 0; i < t.size(); ++i) {
+        const auto range = t.range<preorder_dfs>(
+            static_cast<tree<int>::index_type>(i)
+        );
+        for (const int value: range) {
+            result[i] += value;
+        }
+    }
+    return result;
+}
+
+// Checks the levels and the serial and parallel reductions of a tree
+void test_tree_reductions() {
+    using tree_type = tree<int>;
+    thread_pool pool(4);
+    const auto transform = [](int value) {return long(value);};
+    const auto combine = [](long lhs, long rhs) {return lhs + rhs;};
+    for (unsigned int seed = 0; seed < 4; ++seed) {
+        tree_type t = make_random_tree(1 + seed * 5000, seed);
+        if (seed % 2) {
+            t.linearize();
+        }
+        const auto levels = t.levels();
+        std::size_t count = 0;
+        for (std::size_t level = 0; level < levels.size(); ++level) {
+            const auto first = levels[level].begin();
+            for (auto it = first; it != levels[level].end(); ++it) {
+                const auto index = *it;
+                std::size_t depth = 0;
+                for (auto i = index; !t.is_root(i); i = t.parent(i)) {
+                    ++depth;
+                }
+                EPIDESIM_CHECK(depth == level);
+                EPIDESIM_CHECK(it == first || *(it - 1) < index);
+                ++count;
+            }
+        }
+        EPIDESIM_CHECK(count == t.size());
+        const std::vector<long> expected = subtree_sums(t);
+        std::vector<long> serial(t.size());
+        std::vector<long> parallel(t.size());
+        t.reduce(serial, transform, combine);
+        t.parallel_reduce(pool, parallel, transform, combine);
+        EPIDESIM_CHECK(serial == expected);
+        EPIDESIM_CHECK(parallel == expected);
+    }
+    EPIDESIM_CHECK(tree_type().levels().size() == 0);
+}
+// ========================================================================== //
+
+
+
+// ========================= TREE INCREMENTAL REDUCTIONS ==================== //
+// Checks that refreshing the dirty paths matches a full reduction
+void test_tree_incremental_reductions() {
+    using tree_type = tree<int>;
+    using index_type = tree_type::index_type;
+    const auto transform = [](int value) {return long(value);};
+    const auto combine = [](long lhs, long rhs) {return lhs + rhs;};
+    std::mt19937 engine(11);
+    for (int linearized = 0; linearized < 2; ++linearized) {
+        tree_type t = make_random_tree(3000, 5);
+        if (linearized) {
+            t.linearize();
+        }
+        std::vector<long> sums(t.size());
+        EPIDESIM_CHECK(t.dirty_count() == t.size());
+        t.refresh(sums, transform, combine);
+        EPIDESIM_CHECK(t.dirty_count() == 0 && !t.is_dirty(t.root()));
+        EPIDESIM_CHECK(sums == subtree_sums(t));
+        std::uniform_int_distribution<index_type> node(0, t.size() - 1);
+        for (int round = 0; round < 20; ++round) {
+            for (int i = 0; i < 5; ++i) {
+                const index_type index = node(engine);
+                t[index] += round + 1;
+                t.touch(index);
+                EPIDESIM_CHECK(t.is_dirty(index) && t.is_dirty(t.root()));
+            }
+            EPIDESIM_CHECK(t.dirty_count() < t.size());
+            t.refresh(sums, transform, combine);
+            EPIDESIM_CHECK(t.dirty_count() == 0);
+            EPIDESIM_CHECK(sums == subtree_sums(t));
+        }
+        const index_type leaf = t.emplace_child(node(engine), 1000);
+        sums.resize(t.size());
+        EPIDESIM_CHECK(t.is_dirty(leaf) && t.is_dirty(t.root()));
+        t.refresh(sums, transform, combine);
+        EPIDESIM_CHECK(sums == subtree_sums(t));
+    }
+}
+// ========================================================================== //
+
+
+// ================================== MAIN ================================== //
+// Runs the tests
+int main() {
+    test_tree();
+    test_tree_traversals();
+    test_tree_linearization();
+    test_tree_reductions();
+    test_tree_incremental_reductions();
+    return test_result();
+}
+// ========================================================================== //
@@ -0,0 +1,135 @@
+// ================================= COLUMNS ================================ //
+// Project:         epidesim
+// Name:            columns.cpp
+// Description:     Tests of the packed compartment columns
+// Creator:         Vincent Reverdy
+// Contributor(s):  Vincent Reverdy [2020-]
+// License:         BSD 3-Clause License
+// ========================================================================== //
+
+
+
+// ============================== PREAMBLE ================================== //
+// C++ standard library
+#include <array>
+#include <random>
+#include <vector>
+#include <cstdint>
+// Project sources
+#include "columns.hpp"
+#include "testing.hpp"
+// Third-party libraries
+// Miscellaneous
+using namespace epidesim;
+// ========================================================================== //
+
+
+
+// ============================ COMPARTMENT COLUMN ========================== //
+// Checks a packed column against a plain vector of states
+template <class States>
+void check_compartment_column(unsigned int seed) {
+    using column_type = compartment_column<States>;
+    using value_type = typename column_type::value_type;
+    constexpr std::size_t states = column_type::states;
+    constexpr auto values = pack_values_v<States>;
+    std::mt19937 engine(seed);
+    std::uniform_int_distribution<std::size_t> draw(0, states - 1);
+    std::vector<value_type> reference;
+    column_type column;
+    for (std::size_t i = 0; i < 1000 + seed; ++i) {
+        const value_type value = values[draw(engine)];
+        reference.push_back(value);
+        column.push_back(value);
+    }
+    const auto same = [&] {
+        bool result = column.size() == reference.size();
+        for (std::size_t i = 0; result && i < reference.size(); ++i) {
+            result = column[i] == reference[i];
+        }
+        std::array<std::size_t, states> counts = {};
+        long sum = 0;
+        for (const value_type value: reference) {
+            ++counts[column_type::code(value)];
+            sum += static_cast<long>(value);
+        }
+        for (std::size_t c = 0; c < states; ++c) {
+            result = result && column.count(values[c]) == counts[c];
+        }
+        return result && column.counts() == counts
+        && column.template sum<long>() == sum;
+    };
+    EPIDESIM_CHECK(same());
+    for (std::size_t i = 0; i < reference.size(); i += 7) {
+        reference[i] = values[draw(engine)];
+        column[i] = reference[i];
+    }
+    column[1] = column[2];
+    reference[1] = reference[2];
+    EPIDESIM_CHECK(same());
+    const value_type from = values[0];
+    const value_type to = values[states - 1];
+    std::size_t moved = 0;
+    std::vector<std::uint64_t> mask((reference.size() + 63) / 64);
+    for (std::size_t i = 0; i < reference.size(); ++i) {
+        if (draw(engine) % 2) {
+            mask[i / 64] |= std::uint64_t(1) << (i % 64);
+            if (reference[i] == from) {
+                reference[i] = to;
+                ++moved;
+            }
+        }
+    }
+    EPIDESIM_CHECK(column.transition(from, to, mask) == moved);
+    EPIDESIM_CHECK(same());
+    moved = 0;
+    for (std::size_t i = 0; i < reference.size(); ++i) {
+        moved += reference[i] == to;
+        reference[i] = reference[i] == to ? from : value_type(reference[i]);
+    }
+    EPIDESIM_CHECK(column.transition(to, from) == moved);
+    EPIDESIM_CHECK(same());
+    column.resize(reference.size() + 45, to);
+    reference.resize(reference.size() + 45, to);
+    EPIDESIM_CHECK(same());
+    for (int i = 0; i < 70; ++i) {
+        column.pop_back();
+        reference.pop_back();
+    }
+    EPIDESIM_CHECK(same());
+    column_type filled(130, to);
+    EPIDESIM_CHECK(filled.size() == 130 && filled.count(to) == 130);
+    EPIDESIM_CHECK(filled.words().size() == (130 + column_type::lanes - 1)
+    / column_type::lanes);
+}
+
+// Makes a pack of the provided number of states
+template <std::size_t... Indices>
+nttp_pack<int(Indices * 3)...> make_states(std::index_sequence<Indices...>);
+
+// Checks packed columns of every width of lanes
+void test_compartment_column() {
+    static_assert(compartment_column<bool_pack<false, true>>::bits == 1);
+    static_assert(compartment_column<nttp_pack<0, 1, 2>>::bits == 2);
+    static_assert(compartment_column<nttp_pack<0, 1, 2, 3, 4>>::bits == 4);
+    static_assert(popcount(0xF0F0) == 8 && popcount(~std::uint64_t(0)) == 64);
+    using wide = decltype(make_states(std::make_index_sequence<17>()));
+    static_assert(compartment_column<wide>::bits == 8);
+    for (unsigned int seed = 0; seed < 4; ++seed) {
+        check_compartment_column<bool_pack<false, true>>(seed);
+        check_compartment_column<nttp_pack<0, 1, 2>>(seed);
+        check_compartment_column<nttp_pack<3, 5, 7, 11, 13>>(seed);
+        check_compartment_column<wide>(seed);
+    }
+}
+// ========================================================================== //
+
+
+
+// ================================== MAIN ================================== //
+// Runs the tests
+int main() {
+    test_compartment_column();
+    return test_result();
+}
+// ========================================================================== //
@@ -0,0 +1,187 @@
+// ================================= EVENTS ================================= //
+// Project:         epidesim
+// Name:            events.cpp
+// Description:     Tests of the calendar queue and event engine
+// Creator:         Vincent Reverdy
+// Contributor(s):  Vincent Reverdy [2020-]
+// License:         BSD 3-Clause License
+// ========================================================================== //
+
+
+
+// ============================== PREAMBLE ================================== //
+// C++ standard library
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+// Project sources
+#include "events.hpp"
+#include "parallel.hpp"
+#include "simulation.hpp"
+#include "testing.hpp"
+// Third-party libraries
+// Miscellaneous
+using namespace epidesim;
+// ========================================================================== //
+
+
+
+// ============================= CALENDAR QUEUE ============================= //
+// The tested queue
+using queue_type = calendar_queue<std::uint32_t, double>;
+
+// Checks that events are popped window by window in order of time, across
+// resizes and jumps to distant windows
+void test_calendar_queue_order() {
+    queue_type queue(0.5, 4);
+    EPIDESIM_CHECK(queue.empty() && queue.buckets() == 4);
+    std::mt19937 engine(1);
+    std::exponential_distribution<double> distribution(0.01);
+    std::vector<double> times;
+    for (std::uint32_t i = 0; i < 10000; ++i) {
+        times.push_back(distribution(engine));
+        queue.push(times.back(), i);
+    }
+    queue.push(1e6, 10000);
+    times.push_back(1e6);
+    EPIDESIM_CHECK(queue.size() == 10001 && queue.buckets() > 4);
+    std::vector<queue_type::value_type> output;
+    std::int64_t previous = -1;
+    std::size_t popped = 0;
+    bool ordered = true;
+    while (queue.pop(output)) {
+        const std::int64_t window = queue.window(output.front().time);
+        ordered = ordered && window > previous;
+        ordered = ordered && queue.now() == window * queue.width();
+        for (const queue_type::value_type& value: output) {
+            ordered = ordered && queue.window(value.time) == window;
+            ordered = ordered && times[value.event] == value.time;
+        }
+        previous = window;
+        popped += output.size();
+    }
+    EPIDESIM_CHECK(ordered && popped == 10001 && queue.empty());
+    EPIDESIM_CHECK(output.empty());
+}
+
+// Checks that popping up to a time inside a window keeps the later events of
+// the window, and that events pushed in the past are popped at once
+void test_calendar_queue_until() {
+    queue_type queue(1, 8);
+    std::vector<queue_type::value_type> output;
+    queue.push(2.3, 1);
+    queue.push(2.7, 2);
+    queue.push(2.5, 3);
+    queue.push(13.5, 4);
+    EPIDESIM_CHECK(queue.pop(output, 2.5));
+    EPIDESIM_CHECK(output.size() == 1 && output[0].event == 1);
+    EPIDESIM_CHECK(!queue.pop(output, 2.5) && output.empty());
+    EPIDESIM_CHECK(queue.size() == 3 && queue.now() == 2);
+    EPIDESIM_CHECK(queue.pop(output, 2.6));
+    EPIDESIM_CHECK(output.size() == 1 && output[0].event == 3);
+    queue.push(0.5, 5);
+    EPIDESIM_CHECK(queue.pop(output, 2.6));
+    EPIDESIM_CHECK(output.size() == 1 && output[0].event == 5);
+    EPIDESIM_CHECK(queue.pop(output, 13.5) && output[0].event == 2);
+    EPIDESIM_CHECK(!queue.pop(output, 13.5) && queue.size() == 1);
+    EPIDESIM_CHECK(queue.now() == 13);
+    EPIDESIM_CHECK(queue.pop(output, 14) && output[0].event == 4);
+    EPIDESIM_CHECK(queue.empty());
+}
+
+// Checks the windows of huge and infinite times
+void test_calendar_queue_limits() {
+    constexpr double infinity = std::numeric_limits<double>::infinity();
+    constexpr std::int64_t last = std::numeric_limits<std::int64_t>::max();
+    constexpr std::int64_t first = std::numeric_limits<std::int64_t>::min();
+    queue_type queue(0.25);
+    EPIDESIM_CHECK(queue.window(1.2) == 4 && queue.window(-0.1) == -1);
+    EPIDESIM_CHECK(queue.window(infinity) == last);
+    EPIDESIM_CHECK(queue.window(1e300) == last);
+    EPIDESIM_CHECK(queue.window(-infinity) == first);
+    EPIDESIM_CHECK(queue.window(-1e300) == first);
+    std::vector<queue_type::value_type> output;
+    queue.push(1e300, 1);
+    queue.push(infinity, 2);
+    queue.push(3, 3);
+    EPIDESIM_CHECK(queue.pop(output) && output[0].event == 3);
+    EPIDESIM_CHECK(queue.pop(output) && output[0].event == 1);
+    EPIDESIM_CHECK(!queue.pop(output) && queue.size() == 1);
+    queue.clear();
+    EPIDESIM_CHECK(queue.empty() && !queue.pop(output));
+}
+// ========================================================================== //
+
+
+
+// ============================== EVENT ENGINE ============================== //
+// The tested simulation
+using simulation_type = simulation<type_pack<double_buffered<int>>>;
+using engine_type = event_engine<simulation_type>;
+
+// Checks that advancing processes the events strictly before a time, with
+// the events scheduled on the way, in the same way serially and in parallel
+void test_event_engine() {
+    constexpr std::size_t count = 10000;
+    simulation_type serial(count);
+    simulation_type parallel(count);
+    engine_type serial_engine(serial, 1);
+    engine_type parallel_engine(parallel, 1);
+    EPIDESIM_CHECK(&serial_engine.simulation() == &serial);
+    for (std::uint32_t i = 0; i < count; ++i) {
+        serial_engine.schedule(i, 0.001 * i);
+        parallel_engine.schedule(i, 0.001 * i);
+    }
+    serial_engine.schedule(0, engine_type::never);
+    EPIDESIM_CHECK(serial_engine.pending() == count);
+    const auto handler = [](
+        simulation_type& simulation,
+        std::uint32_t agent,
+        double time
+    ) {
+        const int visits = ++simulation.column<int>()[agent];
+        return visits < 3 ? time + 0.25 : engine_type::never;
+    };
+    const auto expected = [](double from, double until) {
+        std::size_t result = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            double time = 0.001 * i;
+            for (std::size_t visit = 0; visit < 3; ++visit) {
+                result += time >= from && time < until;
+                time += 0.25;
+            }
+        }
+        return result;
+    };
+    thread_pool pool(4);
+    const double stops[] = {0, 2.5, 4.125, 10.25, 100};
+    for (std::size_t i = 1; i < std::size(stops); ++i) {
+        const std::size_t events = expected(stops[i - 1], stops[i]);
+        EPIDESIM_CHECK(serial_engine.advance(stops[i], handler) == events);
+        EPIDESIM_CHECK(
+            parallel_engine.advance(pool, stops[i], handler) == events
+        );
+        EPIDESIM_CHECK(serial_engine.now() <= stops[i]);
+        EPIDESIM_CHECK(serial.column<int>() == parallel.column<int>());
+    }
+    EPIDESIM_CHECK(serial_engine.pending() == 0);
+    EPIDESIM_CHECK(serial.column<int>() == parallel.column<int>());
+    EPIDESIM_CHECK(serial.column<int>() == std::vector<int>(count, 3));
+}
+// ========================================================================== //
+
+
+
+// ================================== MAIN ================================== //
+// Runs the tests
+int main() {
+    test_calendar_queue_order();
+    test_calendar_queue_until();
+    test_calendar_queue_limits();
+    test_event_engine();
+    return test_result();
+}
+// ========================================================================== //
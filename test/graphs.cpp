@@ -0,0 +1,178 @@
+// ================================= GRAPHS ================================= //
+// Project:         epidesim
+// Name:            graphs.cpp
+// Description:     Tests of the multi-layer contact graphs
+// Creator:         Vincent Reverdy
+// Contributor(s):  Vincent Reverdy [2020-]
+// License:         BSD 3-Clause License
+// ========================================================================== //
+
+
+
+// ============================== PREAMBLE ================================== //
+// C++ standard library
+#include <set>
+#include <tuple>
+#include <random>
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <type_traits>
+// Project sources
+#include "graphs.hpp"
+#include "testing.hpp"
+// Third-party libraries
+// Miscellaneous
+using namespace epidesim;
+// ========================================================================== //
+
+
+
+// ============================ CONTACT ITERATOR ============================ //
+// Checks the traversal of the separate columns of edges
+void test_contact_iterator() {
+    using iterator = contact_iterator<std::uint32_t, float>;
+    static_assert(is_random_access_iterator_v<iterator>);
+    static_assert(is_random_access_iterator_v<
+        contact_graph<type_pack<int>>::iterator
+    >);
+    static_assert(is_random_access_iterator_v<
+        contact_graph<type_pack<int>, float>::iterator
+    >);
+    static_assert(std::is_same_v<
+        iterator::iterator_concept,
+        std::random_access_iterator_tag
+    >);
+    static_assert(std::is_same_v<
+        std::iterator_traits<iterator>::value_type,
+        contact_edge<std::uint32_t, float>
+    >);
+    const std::uint32_t targets[] = {4, 8, 15, 16, 23, 42};
+    const float weights[] = {0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f};
+    const iterator first(targets, weights);
+    const iterator last(targets + 6, weights + 6);
+    EPIDESIM_CHECK(last - first == 6 && std::distance(first, last) == 6);
+    EPIDESIM_CHECK((*first).target == 4 && (*first).weight == 0.5f);
+    EPIDESIM_CHECK(first[3].target == 16 && first[3].weight == 3.5f);
+    EPIDESIM_CHECK(first->target == 4 && (first + 5)->weight == 5.5f);
+    EPIDESIM_CHECK((*(last - 1)).target == 42 && (*(2 + first)).target == 15);
+    iterator it = first;
+    EPIDESIM_CHECK((it++).target() == targets && it.target() == targets + 1);
+    EPIDESIM_CHECK((--it) == first && it.weight() == weights);
+    EPIDESIM_CHECK(first < last && last > first && first <= first);
+    EPIDESIM_CHECK(last >= last && first != last);
+    float total = 0;
+    for (iterator current = first; current != last; ++current) {
+        total += (*current).weight;
+    }
+    EPIDESIM_CHECK(total == 18.f);
+    const contact_iterator<std::uint32_t> unweighted(targets);
+    EPIDESIM_CHECK(unweighted[5].target == 42);
+    EPIDESIM_CHECK((unweighted + 1)->target == 8);
+    EPIDESIM_CHECK(*std::lower_bound(
+        unweighted,
+        unweighted + 6,
+        16,
+        [](const auto& edge, std::uint32_t value) {
+            return edge.target < value;
+        }
+    ).target() == 16);
+}
+// ========================================================================== //
+
+
+
+// ============================= CONTACT GRAPH ============================== //
+// Layers of the tested graphs
+struct household {};
+struct workplace {};
+struct school {};
+using layers = type_pack<household, workplace, school>;
+
+// Checks the construction of symmetric and weighted layers against lists of
+// neighbors, and that layers remember whether they were assigned symmetrically
+void test_contact_graph_assign() {
+    constexpr std::size_t vertices = 1000;
+    std::mt19937 engine(3);
+    std::vector<std::pair<int, int>> edges;
+    std::vector<std::tuple<int, int, double>> weighted_edges;
+    std::vector<std::multiset<std::uint32_t>> symmetric(vertices);
+    std::vector<std::vector<std::uint32_t>> directed(vertices);
+    for (std::size_t i = 0; i < 5000; ++i) {
+        const std::uint32_t source = engine() % vertices;
+        const std::uint32_t target = engine() % vertices;
+        edges.emplace_back(source, target);
+        weighted_edges.emplace_back(source, target, source * 0.5);
+        symmetric[source].insert(target);
+        symmetric[target].insert(source);
+        directed[source].push_back(target);
+    }
+    contact_graph<layers> graph(vertices);
+    EPIDESIM_CHECK(!graph.empty() && graph.vertices() == vertices);
+    graph.assign<workplace>(edges, true);
+    contact_graph<layers, float> weighted(vertices);
+    weighted.assign<school>(weighted_edges);
+    EPIDESIM_CHECK(graph.edges() == 10000 && graph.edges<household>() == 0);
+    EPIDESIM_CHECK(weighted.edges<school>() == 5000);
+    EPIDESIM_CHECK(graph.offsets<workplace>().back() == 10000);
+    bool matching = true;
+    for (std::uint32_t vertex = 0; vertex < vertices; ++vertex) {
+        std::multiset<std::uint32_t> neighbors;
+        for (const auto& edge: graph.neighbors<workplace>(vertex)) {
+            neighbors.insert(edge.target);
+        }
+        matching = matching && neighbors == symmetric[vertex];
+        matching = matching && graph.degree(vertex) == neighbors.size();
+        matching = matching && graph.degree<household>(vertex) == 0;
+        std::size_t j = 0;
+        for (const auto& edge: weighted.neighbors<school>(vertex)) {
+            matching = matching && edge.target == directed[vertex][j++];
+            matching = matching && edge.weight == vertex * 0.5f;
+        }
+        matching = matching && j == directed[vertex].size();
+    }
+    EPIDESIM_CHECK(matching);
+    EPIDESIM_CHECK(graph.symmetric<workplace>() && graph.symmetric<school>());
+    EPIDESIM_CHECK(!weighted.symmetric<school>());
+    EPIDESIM_CHECK(weighted.symmetric<household>());
+    weighted.resize(10);
+    EPIDESIM_CHECK(weighted.symmetric<school>());
+    graph.resize(10);
+    EPIDESIM_CHECK(graph.edges() == 0 && graph.degree(9) == 0);
+}
+
+// Checks that renumbering vertices preserves the edges
+void test_contact_graph_permute() {
+    contact_graph<layers, int> graph(4);
+    graph.assign<household>(std::vector<std::tuple<int, int, int>>{
+        {0, 1, 10}, {0, 2, 20}, {3, 0, 30}
+    });
+    graph.assign<school>(std::vector<std::tuple<int, int, int>>{{2, 3, 40}});
+    const std::vector<std::uint32_t> order = {3, 2, 1, 0};
+    const std::vector<std::uint32_t> rank = {3, 2, 1, 0};
+    graph.permute(order, rank);
+    EPIDESIM_CHECK(graph.degree<household>(3) == 2);
+    EPIDESIM_CHECK(graph.degree<household>(0) == 1);
+    EPIDESIM_CHECK(graph.degree<school>(1) == 1);
+    const auto edges = graph.neighbors<household>(3);
+    EPIDESIM_CHECK((*edges.begin()).target == 2);
+    EPIDESIM_CHECK((*edges.begin()).weight == 10);
+    EPIDESIM_CHECK((*graph.neighbors<household>(0).begin()).target == 3);
+    EPIDESIM_CHECK(graph.weights<school>()[0] == 40);
+    EPIDESIM_CHECK(graph.targets<school>()[0] == 0);
+}
+// ========================================================================== //
+
+
+
+// ================================== MAIN ================================== //
+// Runs the tests
+int main() {
+    test_contact_iterator();
+    test_contact_graph_assign();
+    test_contact_graph_permute();
+    return test_result();
+}
+// ========================================================================== //
@@ -0,0 +1,178 @@
+// ================================ MOBILITY ================================ //
+// Project:         epidesim
+// Name:            mobility.cpp
+// Description:     Tests of the bucketing of agents by location
+// Creator:         Vincent Reverdy
+// Contributor(s):  Vincent Reverdy [2020-]
+// License:         BSD 3-Clause License
+// ========================================================================== //
+
+
+
+// ============================== PREAMBLE ================================== //
+// C++ standard library
+#include <atomic>
+#include <random>
+#include <vector>
+#include <cstdint>
+#include <numeric>
+#include <algorithm>
+// Project sources
+#include "mobility.hpp"
+#include "stores.hpp"
+#include "parallel.hpp"
+#include "testing.hpp"
+// Third-party libraries
+// Miscellaneous
+using namespace epidesim;
+// ========================================================================== //
+
+
+
+// ============================ LOCATION BUCKETS ============================ //
+// Returns random locations below a given count
+std::vector<std::uint32_t> random_locations(
+    std::size_t size,
+    std::size_t locations,
+    std::uint32_t seed
+) {
+    std::mt19937 engine(seed);
+    std::vector<std::uint32_t> result(size);
+    for (std::uint32_t& location: result) {
+        location = static_cast<std::uint32_t>(engine() % locations);
+    }
+    return result;
+}
+
+// Checks that agents are sorted stably by location, serially and in parallel
+void test_location_buckets_assign() {
+    thread_pool pool(4);
+    for (std::size_t locations: {1, 10, 100000}) {
+        for (std::size_t size: {0, 1, 1000, 200000}) {
+            const std::vector<std::uint32_t> column = random_locations(
+                size,
+                locations,
+                static_cast<std::uint32_t>(size + locations)
+            );
+            std::vector<std::uint32_t> expected(size);
+            std::iota(expected.begin(), expected.end(), 0);
+            std::stable_sort(expected.begin(), expected.end(), [&](
+                std::uint32_t lhs,
+                std::uint32_t rhs
+            ) {
+                return column[lhs] < column[rhs];
+            });
+            location_buckets serial;
+            location_buckets parallel;
+            serial.assign(column, locations);
+            parallel.assign(pool, column, locations);
+            EPIDESIM_CHECK(serial.agents() == expected);
+            EPIDESIM_CHECK(parallel.agents() == expected);
+            EPIDESIM_CHECK(serial.offsets() == parallel.offsets());
+            EPIDESIM_CHECK(serial.size() == size);
+            EPIDESIM_CHECK(serial.empty() == (size == 0));
+            EPIDESIM_CHECK(serial.locations() == locations);
+            bool valid = true;
+            std::size_t total = 0;
+            for (std::size_t location = 0; location < locations; ++location) {
+                for (const std::uint32_t agent: serial.agents(location)) {
+                    valid = valid && column[agent] == location;
+                }
+                total += serial.occupancy(location);
+            }
+            EPIDESIM_CHECK(valid && total == size);
+        }
+    }
+}
+
+// Checks the gathering, scattering and iteration in bucket order
+void test_location_buckets_access() {
+    thread_pool pool(4);
+    constexpr std::size_t size = 50000;
+    constexpr std::size_t locations = 300;
+    const std::vector<std::uint32_t> column = random_locations(
+        size,
+        locations,
+        42
+    );
+    location_buckets buckets;
+    buckets.assign(pool, column, locations);
+    std::vector<double> values(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        values[i] = static_cast<double>(i) / 2;
+    }
+    std::vector<double> gathered;
+    buckets.gather(pool, values, gathered);
+    bool valid = gathered.size() == size;
+    for (std::size_t i = 0; i < size && valid; ++i) {
+        valid = gathered[i] == values[buckets.agents()[i]];
+    }
+    EPIDESIM_CHECK(valid);
+    std::vector<double> scattered(size);
+    buckets.scatter(pool, gathered, scattered);
+    EPIDESIM_CHECK(scattered == values);
+    std::vector<std::atomic<std::size_t>> visits(locations);
+    std::atomic<std::size_t> agents = 0;
+    buckets.for_each_location(pool, [&](std::size_t location, auto span) {
+        ++visits[location];
+        agents += static_cast<std::size_t>(span.end() - span.begin());
+    });
+    valid = agents == size;
+    for (const std::atomic<std::size_t>& count: visits) {
+        valid = valid && count == 1;
+    }
+    EPIDESIM_CHECK(valid);
+}
+// ========================================================================== //
+
+
+
+// ================================ MOBILITY ================================ //
+// Activities of the tested schedules
+struct home {};
+struct work {};
+using activities = type_pack<home, work>;
+using schema = type_pack<location_index<home>, location_index<work>>;
+
+// Checks that buckets are built once per activity until invalidated
+void test_mobility() {
+    static_assert(mobility<activities>::activity_index<home>() == 0);
+    static_assert(mobility<activities>::activity_index<work>() == 1);
+    soa_store<schema> store;
+    for (std::uint32_t i = 0; i < 1000; ++i) {
+        store.push_back(
+            location_index<home>{i / 4},
+            location_index<work>{i % 7}
+        );
+    }
+    mobility<activities> schedule;
+    EPIDESIM_CHECK(!schedule.valid<home>() && !schedule.valid<work>());
+    const location_buckets& homes = schedule.buckets<home>(store, 250);
+    EPIDESIM_CHECK(schedule.valid<home>() && schedule.rebuilds() == 1);
+    EPIDESIM_CHECK(homes.locations() == 250 && homes.occupancy(17) == 4);
+    EPIDESIM_CHECK(&schedule.buckets<home>(store, 250) == &homes);
+    EPIDESIM_CHECK(schedule.rebuilds() == 1);
+    thread_pool pool(2);
+    const location_buckets& works = schedule.buckets<work>(pool, store, 7);
+    EPIDESIM_CHECK(works.occupancy(0) == 143 && works.occupancy(6) == 142);
+    EPIDESIM_CHECK(schedule.rebuilds() == 2);
+    schedule.invalidate<home>();
+    EPIDESIM_CHECK(!schedule.valid<home>() && schedule.valid<work>());
+    schedule.buckets<home>(store, 250);
+    EPIDESIM_CHECK(schedule.rebuilds() == 3);
+    schedule.invalidate();
+    EPIDESIM_CHECK(!schedule.valid<home>() && !schedule.valid<work>());
+}
+// ========================================================================== //
+
+
+
+// ================================== MAIN ================================== //
+// Runs the tests
+int main() {
+    test_location_buckets_assign();
+    test_location_buckets_access();
+    test_mobility();
+    return test_result();
+}
+// ========================================================================== //
@@ -0,0 +1,143 @@
+// ================================= MODELS ================================= //
+// Project:         epidesim
+// Name:            models.cpp
+// Description:     Tests of the compile-time compartmental models
+// Creator:         Vincent Reverdy
+// Contributor(s):  Vincent Reverdy [2020-]
+// License:         BSD 3-Clause License
+// ========================================================================== //
+
+
+
+// ============================== PREAMBLE ================================== //
+// C++ standard library
+#include <cmath>
+#include <vector>
+#include <cstdint>
+#include <type_traits>
+// Project sources
+#include "models.hpp"
+#include "columns.hpp"
+#include "testing.hpp"
+// Third-party libraries
+// Miscellaneous
+using namespace epidesim;
+// ========================================================================== //
+
+
+
+// ========================== OUTGOING TRANSITIONS ========================== //
+// Compartments and transitions of the tested models
+struct susceptible {};
+struct exposed {};
+struct infectious {};
+struct recovered {};
+struct dead {};
+using infection = transition<
+    susceptible,
+    exposed,
+    decltype(scientific_v<1, -1>)
+>;
+using onset = transition<exposed, infectious, decltype(scientific_v<25, -2>)>;
+using recovery = transition<
+    infectious,
+    recovered,
+    decltype(scientific_v<2, -1>)
+>;
+using death = transition<infectious, dead, decltype(scientific_v<1, -2>)>;
+using seird_transitions = transitions<infection, onset, recovery, death>;
+
+// Checks that the transitions leaving each compartment are listed in order
+void test_outgoing_transitions() {
+    static_assert(std::is_same_v<
+        outgoing_transitions_t<infectious, seird_transitions>,
+        transitions<recovery, death>
+    >);
+    static_assert(std::is_same_v<
+        outgoing_transitions_t<dead, seird_transitions>,
+        transitions<>
+    >);
+    static_assert(outgoing_transitions_v<susceptible, seird_transitions> == 1);
+    static_assert(outgoing_transitions_v<infectious, seird_transitions> == 2);
+    static_assert(outgoing_transitions_v<recovered, transitions<>> == 0);
+    static_assert(infection::rate == 0.1);
+    EPIDESIM_CHECK(recovery::rate == 0.2);
+}
+// ========================================================================== //
+
+
+
+// ================================== MODEL ================================= //
+// The tested model
+using seird = model<
+    type_pack<susceptible, exposed, infectious, recovered, dead>,
+    seird_transitions
+>;
+
+// Checks the properties and the kernel of a model at compile time
+void test_model_properties() {
+    static_assert(seird::compartment_count() == 5);
+    static_assert(seird::transition_count() == 4);
+    static_assert(seird::code<susceptible>() == 0);
+    static_assert(seird::code<infectious>() == 2);
+    static_assert(seird::code<dead>() == 4);
+    static_assert(seird::degrees()[0] == 1 && seird::degrees()[2] == 2);
+    static_assert(seird::degrees()[3] == 0 && seird::degrees()[4] == 0);
+    static_assert(std::is_same_v<
+        seird::states_type,
+        nttp_pack<std::uint8_t(0), std::uint8_t(1), std::uint8_t(2),
+        std::uint8_t(3), std::uint8_t(4)>
+    >);
+    static_assert(seird::next(0, 0.01) == 1);
+    static_assert(seird::next(0, 0.5) == 0);
+    static_assert(seird::next(2, 0.) == 3);
+    static_assert(seird::next(2, 0.185) == 4);
+    static_assert(seird::next(2, 0.2) == 2);
+    static_assert(seird::next(3, 0.) == 3 && seird::next(4, 0.) == 4);
+    using ten = floating_point_constant<double, 1, 10, 1>;
+    static_assert(seird::next<ten>(1, 0.9) == 2);
+    EPIDESIM_CHECK(seird::next(1, 0.2) == 2 && seird::next(1, 0.3) == 1);
+}
+
+// Checks the fractions of agents changing compartment during steps against
+// the probabilities derived from the rates
+void test_model_step() {
+    constexpr std::size_t count = 100000;
+    std::vector<std::uint8_t> codes(count, seird::code<infectious>());
+    std::vector<double> uniforms(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        uniforms[i] = (static_cast<double>(i) + 0.5) / count;
+    }
+    const std::size_t changes = seird::step(codes, uniforms);
+    const double leave = 1 - std::exp(-0.21);
+    std::size_t recoveries = 0;
+    std::size_t deaths = 0;
+    for (std::uint8_t code: codes) {
+        recoveries += code == seird::code<recovered>();
+        deaths += code == seird::code<dead>();
+    }
+    EPIDESIM_CHECK(changes == recoveries + deaths);
+    EPIDESIM_CHECK(std::abs(changes - leave * count) <= 1);
+    EPIDESIM_CHECK(std::abs(deaths - leave * count / 21) <= 1);
+    std::vector<std::uint8_t> dead_codes(count, seird::code<dead>());
+    EPIDESIM_CHECK(seird::step(dead_codes, uniforms) == 0);
+    using forever = floating_point_constant<double, 1, 10, 9>;
+    std::vector<std::uint8_t> exposed_codes(count, seird::code<exposed>());
+    EPIDESIM_CHECK(seird::step<forever>(exposed_codes, uniforms) == count);
+    compartment_column<seird::states_type> column(count, 2);
+    EPIDESIM_CHECK(seird::step(column, uniforms) == changes);
+    EPIDESIM_CHECK(column.counts()[seird::code<dead>()] == deaths);
+}
+// ========================================================================== //
+
+
+
+// ================================== MAIN ================================== //
+// Runs the tests
+int main() {
+    test_outgoing_transitions();
+    test_model_properties();
+    test_model_step();
+    return test_result();
+}
+// ========================================================================== //
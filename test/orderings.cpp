@@ -0,0 +1,206 @@
+// ================================ ORDERINGS =============================== //
+// Project:         epidesim
+// Name:            orderings.cpp
+// Description:     Tests of the locality-improving renumberings
+// Creator:         Vincent Reverdy
+// Contributor(s):  Vincent Reverdy [2020-]
+// License:         BSD 3-Clause License
+// ========================================================================== //
+
+
+
+// ============================== PREAMBLE ================================== //
+// C++ standard library
+#include <set>
+#include <tuple>
+#include <random>
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+// Project sources
+#include "orderings.hpp"
+#include "bases.hpp"
+#include "stores.hpp"
+#include "graphs.hpp"
+#include "testing.hpp"
+// Third-party libraries
+// Miscellaneous
+using namespace epidesim;
+// ========================================================================== //
+
+
+
+// ============================== PERMUTATIONS ============================== //
+// Values of the leaves of the tested trees
+struct leaf {
+    std::uint32_t agent;
+};
+
+// Checks the inversion of orders and the gathering of columns and leaves
+void test_permutations() {
+    const ordering order = {2, 0, 3, 1};
+    const ordering rank = invert_ordering(order);
+    EPIDESIM_CHECK(rank == ordering({1, 3, 0, 2}));
+    std::vector<int> column = {10, 11, 12, 13};
+    permute_column(column, order);
+    EPIDESIM_CHECK(column == std::vector<int>({12, 10, 13, 11}));
+    soa_store<type_pack<int, float>> store;
+    for (int i = 0; i < 4; ++i) {
+        store.push_back(i, i * 0.5f);
+    }
+    permute_columns(store, order);
+    EPIDESIM_CHECK(store.column<int>() == std::vector<int>({2, 0, 3, 1}));
+    EPIDESIM_CHECK(store.column<float>()[2] == 1.5f);
+    tree<leaf> leaves(std::in_place, leaf{0});
+    for (std::uint32_t i = 0; i < 4; ++i) {
+        leaves.emplace_child(0, leaf{i});
+    }
+    renumber_leaves(leaves, rank, [](leaf& value) -> std::uint32_t& {
+        return value.agent;
+    });
+    bool renumbered = leaves[0].agent == 0;
+    for (std::uint32_t i = 1; i <= 4; ++i) {
+        renumbered = renumbered && leaves[i].agent == rank[i - 1];
+    }
+    EPIDESIM_CHECK(renumbered);
+}
+// ========================================================================== //
+
+
+
+// ============================ HOUSEHOLD MAJOR ============================= //
+// Checks that agents are grouped by household in their former relative order
+void test_household_major_ordering() {
+    const std::vector<std::uint16_t> households = {3, 1, 3, 0, 1, 3, 0};
+    const ordering order = household_major_ordering(households);
+    EPIDESIM_CHECK(order == ordering({3, 6, 1, 4, 0, 2, 5}));
+    EPIDESIM_CHECK(household_major_ordering(std::vector<int>()).empty());
+}
+// ========================================================================== //
+
+
+
+// ========================= REVERSE CUTHILL MCKEE ========================== //
+// Layers of the tested graphs
+struct household {};
+struct workplace {};
+
+// Returns the largest distance between the indices of neighbors
+template <class Graph>
+std::size_t bandwidth(const Graph& graph) {
+    std::size_t result = 0;
+    for (std::uint32_t vertex = 0; vertex < graph.vertices(); ++vertex) {
+        for (const auto& edge: graph.neighbors(1, vertex)) {
+            result = std::max<std::size_t>(result, edge.target > vertex
+                ? edge.target - vertex
+                : vertex - edge.target
+            );
+        }
+    }
+    return result;
+}
+
+// Checks that a shuffled chain is renumbered into a band, and that edges and
+// weights are preserved by the renumbering
+void test_reverse_cuthill_mckee_ordering() {
+    constexpr std::uint32_t vertices = 2000;
+    ordering shuffle(vertices);
+    for (std::uint32_t i = 0; i < vertices; ++i) {
+        shuffle[i] = i;
+    }
+    std::shuffle(shuffle.begin(), shuffle.end(), std::mt19937(5));
+    std::vector<std::tuple<std::uint32_t, std::uint32_t, float>> edges;
+    for (std::uint32_t i = 0; i + 1 < vertices; ++i) {
+        edges.emplace_back(shuffle[i], shuffle[i + 1], float(i));
+    }
+    using graph_type = contact_graph<type_pack<household, workplace>, float>;
+    graph_type graph(vertices);
+    graph.assign<workplace>(edges, true);
+    const graph_type original = graph;
+    const ordering order = reverse_cuthill_mckee_ordering(graph);
+    const ordering rank = invert_ordering(order);
+    std::vector<char> seen(vertices);
+    for (std::uint32_t vertex: order) {
+        seen[vertex] = true;
+    }
+    EPIDESIM_CHECK(order.size() == vertices);
+    EPIDESIM_CHECK(std::count(seen.begin(), seen.end(), true) == vertices);
+    graph.permute(order, rank);
+    EPIDESIM_CHECK(bandwidth(original) > 100 && bandwidth(graph) == 1);
+    bool preserved = true;
+    for (std::uint32_t vertex = 0; vertex < vertices; ++vertex) {
+        std::multiset<std::pair<std::uint32_t, float>> permuted;
+        std::multiset<std::pair<std::uint32_t, float>> expected;
+        for (const auto& edge: graph.neighbors<workplace>(vertex)) {
+            permuted.emplace(order[edge.target], edge.weight);
+        }
+        for (const auto& edge: original.neighbors<workplace>(order[vertex])) {
+            expected.emplace(edge.target, edge.weight);
+        }
+        preserved = preserved && permuted == expected;
+    }
+    EPIDESIM_CHECK(preserved);
+}
+// ========================================================================== //
+
+
+
+// ============================== HILBERT CURVE ============================= //
+// Checks that the Hilbert curve visits each cell once by steps between
+// adjacent cells, including on the largest grid
+void test_hilbert_index() {
+    static_assert(hilbert_index(0, 0, 1) == 0 && hilbert_index(0, 1, 1) == 1);
+    static_assert(hilbert_index(1, 1, 1) == 2 && hilbert_index(1, 0, 1) == 3);
+    static_assert(hilbert_index(0, 0, 0) == 0);
+    constexpr std::uint32_t side = 16;
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> cells(side * side);
+    std::vector<char> seen(side * side);
+    for (std::uint32_t x = 0; x < side; ++x) {
+        for (std::uint32_t y = 0; y < side; ++y) {
+            const std::uint64_t index = hilbert_index(x, y, 4);
+            seen[index] = true;
+            cells[index] = {x, y};
+        }
+    }
+    bool adjacent = true;
+    for (std::size_t i = 1; i < cells.size(); ++i) {
+        const std::uint32_t dx = cells[i].first - cells[i - 1].first;
+        const std::uint32_t dy = cells[i].second - cells[i - 1].second;
+        adjacent = adjacent && (dx * dx + dy * dy) == 1;
+    }
+    EPIDESIM_CHECK(adjacent);
+    EPIDESIM_CHECK(std::count(seen.begin(), seen.end(), true) == side * side);
+    constexpr std::uint32_t last = 0xFFFFFFFF;
+    EPIDESIM_CHECK(hilbert_index(last, 0, 32) == ~std::uint64_t(0));
+    EPIDESIM_CHECK(hilbert_index(0, last, 32) == 0x5555555555555555);
+    EPIDESIM_CHECK(hilbert_index(0, 0, 32) == 0);
+}
+
+// Checks that agents are ordered along the curve over their bounding box
+void test_hilbert_ordering() {
+    const std::vector<double> x = {10, 11, 10, 11, 10.5};
+    const std::vector<double> y = {-5, -4, -4, -5, -4.5};
+    const ordering order = hilbert_ordering(x, y, 1);
+    EPIDESIM_CHECK(order == ordering({0, 4, 2, 1, 3}));
+    EPIDESIM_CHECK(hilbert_ordering(x, y, 32).size() == 5);
+    EPIDESIM_CHECK(hilbert_ordering(x, y).size() == 5);
+    const std::vector<float> same(3, 1.f);
+    EPIDESIM_CHECK(hilbert_ordering(same, same) == ordering({0, 1, 2}));
+    EPIDESIM_CHECK(hilbert_ordering(std::vector<int>(), y).empty());
+}
+// ========================================================================== //
+
+
+
+// ================================== MAIN ================================== //
+// Runs the tests
+int main() {
+    test_permutations();
+    test_household_major_ordering();
+    test_reverse_cuthill_mckee_ordering();
+    test_hilbert_index();
+    test_hilbert_ordering();
+    return test_result();
+}
+// ========================================================================== //
@@ -0,0 +1,164 @@
+// ================================== PACK ================================== //
+// Project:         epidesim
+// Name:            pack.cpp
+// Description:     Tests of the algorithms on type packs
+// Creator:         Vincent Reverdy
+// Contributor(s):  Vincent Reverdy [2020-]
+// License:         BSD 3-Clause License
+// ========================================================================== //
+
+
+
+// ============================== PREAMBLE ================================== //
+// C++ standard library
+#include <cstddef>
+#include <utility>
+#include <type_traits>
+// Project sources
+#include "pack.hpp"
+#include "wrappers.hpp"
+#include "testing.hpp"
+// Third-party libraries
+// Miscellaneous
+using namespace epidesim;
+// ========================================================================== //
+
+
+
+// =============================== PACK CONCAT ============================== //
+// An incomplete type, which the algorithms should never need to instantiate
+struct incomplete;
+
+// A type whose instantiation fails, which the algorithms should never need
+template <class T>
+struct poisoned {
+    static_assert(sizeof(T) == 0, "instantiated");
+};
+
+// Makes a pack of distinct types: declaration
+template <class Indices>
+struct numbered;
+
+// Makes a pack of distinct types: indexed specialization
+template <std::size_t... Indices>
+struct numbered<std::index_sequence<Indices...>> {
+    using type = type_pack<std::integral_constant<std::size_t, Indices>...>;
+};
+
+// Alias template
+template <std::size_t Size>
+using numbered_t = typename numbered<std::make_index_sequence<Size>>::type;
+
+// Makes a pack of single type packs: declaration
+template <class Pack>
+struct singletons;
+
+// Makes a pack of single type packs: type pack specialization
+template <class... Types>
+struct singletons<type_pack<Types...>> {
+    using type = pack_concat_t<type_pack<Types>...>;
+};
+
+// Checks the concatenation of empty, single and several packs
+void test_pack_concat() {
+    static_assert(std::is_same_v<pack_concat_t<>, type_pack<>>);
+    static_assert(std::is_same_v<
+        pack_concat_t<type_pack<int, char>>,
+        type_pack<int, char>
+    >);
+    static_assert(std::is_same_v<
+        pack_concat_t<type_pack<int>, type_pack<>, type_pack<char, int>>,
+        type_pack<int, char, int>
+    >);
+    static_assert(std::is_same_v<
+        pack_concat_t<
+            type_pack<>, type_pack<short>, type_pack<int, long>,
+            type_pack<float>, type_pack<>, type_pack<double, char>,
+            type_pack<bool>
+        >,
+        type_pack<short, int, long, float, double, char, bool>
+    >);
+    static_assert(std::is_same_v<
+        pack_concat_t<type_pack<incomplete>, type_pack<poisoned<int>>>,
+        type_pack<incomplete, poisoned<int>>
+    >);
+    static_assert(std::is_same_v<
+        pack_concat_t<type_pack<int>, type_pack<int>, type_pack<int>>,
+        type_pack<int, int, int>
+    >);
+    static_assert(std::is_same_v<
+        typename singletons<numbered_t<257>>::type,
+        numbered_t<257>
+    >);
+    static_assert(pack_size_v<pack_concat_t<
+        numbered_t<100>, numbered_t<50>, numbered_t<1>
+    >> == 151);
+}
+// ========================================================================== //
+
+
+
+// ============================ PACK ALGORITHMS ============================= //
+// Checks the filtering and the transformation of types by wrapped traits
+void test_pack_filter_transform() {
+    using pack = type_pack<int, float, char, double, incomplete*, long>;
+    static_assert(std::is_same_v<
+        pack_filter_t<pack, type_trait<std::is_integral>>,
+        type_pack<int, char, long>
+    >);
+    static_assert(std::is_same_v<
+        pack_filter_t<pack, type_trait<std::is_same>, float>,
+        type_pack<float>
+    >);
+    static_assert(std::is_same_v<
+        pack_filter_t<type_pack<>, type_trait<std::is_integral>>,
+        type_pack<>
+    >);
+    static_assert(std::is_same_v<
+        pack_transform_t<pack, type_trait<std::add_pointer>>,
+        type_pack<int*, float*, char*, double*, incomplete**, long*>
+    >);
+    static_assert(std::is_same_v<
+        pack_transform_t<type_pack<>, type_trait<std::add_pointer>>,
+        type_pack<>
+    >);
+}
+
+// Checks the search and the removal of duplicated types
+void test_pack_index_of_unique() {
+    using pack = type_pack<int, float, int, char, float, incomplete>;
+    static_assert(pack_index_of_v<pack, int> == 0);
+    static_assert(pack_index_of_v<pack, char> == 3);
+    static_assert(pack_index_of_v<pack, incomplete> == 5);
+    static_assert(pack_index_of_v<pack, double> == 6);
+    static_assert(pack_index_of_v<type_pack<>, int> == 0);
+    static_assert(std::is_same_v<
+        pack_unique_t<pack>,
+        type_pack<int, float, char, incomplete>
+    >);
+    static_assert(std::is_same_v<pack_unique_t<type_pack<>>, type_pack<>>);
+    static_assert(std::is_same_v<
+        pack_unique_t<type_pack<poisoned<int>, incomplete, poisoned<int>>>,
+        type_pack<poisoned<int>, incomplete>
+    >);
+    static_assert(std::is_same_v<
+        pack_unique_t<numbered_t<64>>,
+        numbered_t<64>
+    >);
+    static_assert(pack_size_v<pack_unique_t<pack_concat_t<
+        numbered_t<40>, numbered_t<60>, numbered_t<20>
+    >>> == 60);
+}
+// ========================================================================== //
+
+
+
+// ================================== MAIN ================================== //
+// Runs the tests
+int main() {
+    test_pack_concat();
+    test_pack_filter_transform();
+    test_pack_index_of_unique();
+    return test_result();
+}
+// ========================================================================== //
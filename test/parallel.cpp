@@ -0,0 +1,224 @@
+// ================================ PARALLEL ================================ //
+// Project:         epidesim
+// Name:            parallel.cpp
+// Description:     Tests of the thread pool and parallel loops
+// Creator:         Vincent Reverdy
+// Contributor(s):  Vincent Reverdy [2020-]
+// License:         BSD 3-Clause License
+// ========================================================================== //
+
+
+
+// ============================== PREAMBLE ================================== //
+// C++ standard library
+#include <atomic>
+#include <random>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <numeric>
+#include <algorithm>
+#include <stdexcept>
+#include <functional>
+// Project sources
+#include "parallel.hpp"
+#include "testing.hpp"
+// Third-party libraries
+// Miscellaneous
+using namespace epidesim;
+// ========================================================================== //
+
+
+
+// =============================== THREAD POOL ============================== //
+// Checks that each index of a loop is visited exactly once
+void test_thread_pool_coverage() {
+    thread_pool pool(4);
+    EPIDESIM_CHECK(pool.size() == 4);
+    EPIDESIM_CHECK(thread_pool(0).size() == 1);
+    EPIDESIM_CHECK(thread_pool::default_concurrency() >= 1);
+    for (std::size_t chunk: {1, 7, 64, 1024}) {
+        std::vector<std::atomic<int>> visits(100003);
+        pool.parallel_for(3, visits.size(), chunk, [&visits](std::size_t i) {
+            visits[i].fetch_add(1, std::memory_order_relaxed);
+        });
+        bool once = visits[0] == 0 && visits[1] == 0 && visits[2] == 0;
+        for (std::size_t i = 3; i < visits.size(); ++i) {
+            once = once && visits[i] == 1;
+        }
+        EPIDESIM_CHECK(once);
+    }
+    std::size_t calls = 0;
+    pool.parallel_for(5, 5, [&calls](std::size_t) {++calls;});
+    pool.parallel_for(6, 5, [&calls](std::size_t) {++calls;});
+    EPIDESIM_CHECK(calls == 0);
+    std::vector<std::uint64_t> sums(64);
+    pool.parallel_for(0, sums.size(), 1, [&pool, &sums](std::size_t i) {
+        pool.parallel_for(0, 1000, 10, [&sums, i](std::size_t j) {
+            sums[i] += j;
+        });
+    });
+    EPIDESIM_CHECK(std::accumulate(sums.begin(), sums.end(), 0ULL)
+    == 64 * 999 * 1000 / 2);
+}
+
+// Checks that the first exception thrown by a task is rethrown, and that the
+// pool remains usable afterwards
+void test_thread_pool_exceptions() {
+    thread_pool pool(4);
+    bool thrown = false;
+    try {
+        pool.parallel_for(0, 100000, 16, [](std::size_t i) {
+            if (i % 1000 == 999) {
+                throw std::runtime_error("failure");
+            }
+        });
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    EPIDESIM_CHECK(thrown);
+    std::atomic<std::size_t> count = 0;
+    pool.parallel_for(0, 100000, 16, [&count](std::size_t) {++count;});
+    EPIDESIM_CHECK(count == 100000);
+}
+
+// Checks that worker indices identify the threads executing a loop
+void test_thread_pool_workers() {
+    thread_pool pool(4);
+    EPIDESIM_CHECK(pool.worker() == 0);
+    std::vector<std::atomic<std::size_t>> threads(pool.size());
+    std::atomic<bool> valid = true;
+    pool.parallel_for(0, 100000, 16, [&](std::size_t) {
+        const std::size_t worker = pool.worker();
+        if (worker >= pool.size()) {
+            valid = false;
+            return;
+        }
+        const std::size_t id = std::hash<std::thread::id>()(
+            std::this_thread::get_id()
+        );
+        std::size_t expected = 0;
+        if (!threads[worker].compare_exchange_strong(expected, id)
+            && expected != id) {
+            valid = false;
+        }
+    });
+    EPIDESIM_CHECK(valid);
+    EPIDESIM_CHECK(threads[0] == std::hash<std::thread::id>()(
+        std::this_thread::get_id()
+    ));
+    thread_pool other(2);
+    std::vector<std::size_t> nested(pool.size() * 8);
+    pool.parallel_for(0, nested.size(), 1, [&](std::size_t i) {
+        nested[i] = other.worker() * 100 + pool.worker();
+        pool.parallel_for(0, 10, 1, [&](std::size_t) {
+            valid = valid && nested[i] == other.worker() * 100 + pool.worker();
+        });
+    });
+    EPIDESIM_CHECK(valid);
+    EPIDESIM_CHECK(*std::max_element(nested.begin(), nested.end()) < 4);
+    EPIDESIM_CHECK(sequential_executor::worker() == 0);
+}
+
+// Checks the counters of the scheduling activity
+void test_thread_pool_counters() {
+    thread_pool pool(4);
+    pool.reset_counters();
+    constexpr std::size_t loops = 50;
+    for (std::size_t loop = 0; loop < loops; ++loop) {
+        pool.parallel_for(0, 10000, 100, [](std::size_t) {});
+    }
+    thread_pool_counters counters = pool.counters();
+    EPIDESIM_CHECK(counters.chunks == loops * 100);
+    EPIDESIM_CHECK(counters.idle <= loops * (pool.size() - 1));
+    pool.reset_counters();
+    pool.parallel_for(0, 10, 100, [](std::size_t) {});
+    counters = pool.counters();
+    EPIDESIM_CHECK(counters.chunks == 0 && counters.steals == 0);
+    EPIDESIM_CHECK(counters.failed_steals == 0 && counters.idle == 0);
+    thread_pool single(1);
+    single.parallel_for(0, 100000, 10, [](std::size_t) {});
+    EPIDESIM_CHECK(single.counters().idle == 0);
+}
+// ========================================================================== //
+
+
+
+// =========================== SEQUENTIAL EXECUTOR ========================== //
+// Checks that the sequential executor visits indices in order
+void test_sequential_executor() {
+    sequential_executor executor;
+    static_assert(sequential_executor::size() == 1);
+    std::vector<std::size_t> visited;
+    executor.parallel_for(2, 7, [&visited](std::size_t i) {
+        visited.push_back(i);
+    });
+    executor.parallel_for(7, 9, 1, [&visited](std::size_t i) {
+        visited.push_back(i);
+    });
+    std::vector<std::size_t> expected(7);
+    std::iota(expected.begin(), expected.end(), 2);
+    EPIDESIM_CHECK(visited == expected);
+}
+// ========================================================================== //
+
+
+
+// ============================== COUNTING SORT ============================= //
+// Checks that indices are sorted stably by keys with the offsets of the keys,
+// whatever the executor and the number of blocks
+void test_counting_sort() {
+    thread_pool pool(4);
+    sequential_executor sequential;
+    for (std::size_t keys: {1, 7, 5000, 100000}) {
+        for (std::size_t size: {0, 1, 1000, 100000}) {
+            std::vector<std::uint32_t> column(size);
+            std::mt19937 engine(static_cast<std::uint32_t>(keys + size));
+            for (std::uint32_t& key: column) {
+                key = static_cast<std::uint32_t>(engine() % keys);
+            }
+            const auto key = [&column](std::size_t i) {return column[i];};
+            std::vector<std::uint32_t> expected(size);
+            std::iota(expected.begin(), expected.end(), 0);
+            std::stable_sort(expected.begin(), expected.end(), [&](
+                std::uint32_t lhs,
+                std::uint32_t rhs
+            ) {
+                return column[lhs] < column[rhs];
+            });
+            std::vector<std::size_t> offsets;
+            std::vector<std::uint32_t> indices;
+            std::vector<std::size_t> counts;
+            counting_sort(pool, size, keys, key, offsets, indices, counts);
+            EPIDESIM_CHECK(indices == expected);
+            EPIDESIM_CHECK(offsets.size() == keys + 1);
+            EPIDESIM_CHECK(offsets.front() == 0 && offsets.back() == size);
+            bool valid = true;
+            for (std::size_t k = 0; k < keys; ++k) {
+                for (std::size_t i = offsets[k]; i < offsets[k + 1]; ++i) {
+                    valid = valid && column[indices[i]] == k;
+                }
+            }
+            EPIDESIM_CHECK(valid);
+            EPIDESIM_CHECK(counts.size() <= std::max(size, keys) + 5);
+            std::vector<std::size_t> serial;
+            counting_sort(sequential, size, keys, key, serial, indices, counts);
+            EPIDESIM_CHECK(serial == offsets && indices == expected);
+        }
+    }
+}
+
+
+
+// ================================== MAIN ================================== //
+// Runs the tests
+int main() {
+    test_thread_pool_coverage();
+    test_thread_pool_exceptions();
+    test_thread_pool_workers();
+    test_thread_pool_counters();
+    test_sequential_executor();
+    test_counting_sort();
+    return test_result();
+}
+// ========================================================================== //
@@ -0,0 +1,125 @@
+// ================================= RANDOM ================================= //
+// Project:         epidesim
+// Name:            random.cpp
+// Description:     Tests of the counter-based generators
+// Creator:         Vincent Reverdy
+// Contributor(s):  Vincent Reverdy [2020-]
+// License:         BSD 3-Clause License
+// ========================================================================== //
+
+
+
+// ============================== PREAMBLE ================================== //
+// C++ standard library
+#include <cmath>
+#include <array>
+#include <limits>
+#include <random>
+#include <vector>
+#include <cstdint>
+// Project sources
+#include "random.hpp"
+#include "testing.hpp"
+// Third-party libraries
+// Miscellaneous
+using namespace epidesim;
+// ========================================================================== //
+
+
+
+// ============================ COUNTER BASED RNG =========================== //
+// Checks that draws are pure functions of their counters and keys
+template <class Bijection>
+void check_counter_based_rng() {
+    using rng_type = counter_based_rng<Bijection>;
+    using word_type = typename rng_type::word_type;
+    const rng_type rng(0x0123456789ABCDEF, 3, 1);
+    EPIDESIM_CHECK(rng.seed() == 0x0123456789ABCDEF);
+    EPIDESIM_CHECK(rng.tick() == 3 && rng.stream() == 1);
+    EPIDESIM_CHECK(rng.at(4).tick() == 4 && rng.with(2).stream() == 2);
+    EPIDESIM_CHECK(rng.bits(10) == rng.bits(10));
+    EPIDESIM_CHECK(rng.bits(10) != rng.bits(11));
+    EPIDESIM_CHECK(rng.bits(10) != rng.bits(10, 1));
+    EPIDESIM_CHECK(rng.bits(10) != rng.at(4).bits(10));
+    EPIDESIM_CHECK(rng.bits(10) != rng.with(2).bits(10));
+    EPIDESIM_CHECK(rng.bits(10) != rng_type(1, 3, 1).bits(10));
+    EPIDESIM_CHECK(rng.block_bits(2)[3] == rng.bits(11));
+    std::vector<word_type> words(1001);
+    rng.fill_bits(5, words, 2);
+    bool same = true;
+    for (std::size_t i = 0; i < words.size(); ++i) {
+        same = same && words[i] == rng.bits(std::uint32_t(5 + i), 2);
+    }
+    EPIDESIM_CHECK(same);
+    std::vector<double> uniforms(1001);
+    rng.fill_uniform(7, uniforms);
+    same = true;
+    double mean = 0;
+    for (std::size_t i = 0; i < uniforms.size(); ++i) {
+        same = same && uniforms[i] == rng.uniform(std::uint32_t(7 + i));
+        mean += uniforms[i] / uniforms.size();
+    }
+    EPIDESIM_CHECK(same && std::abs(mean - 0.5) < 0.05);
+    std::array<std::size_t, 2> ones = {};
+    for (std::uint32_t agent = 0; agent < 10000; ++agent) {
+        const word_type word = rng.bits(agent);
+        ones[0] += word & 1;
+        ones[1] += word >> 31;
+    }
+    EPIDESIM_CHECK(ones[0] > 4800 && ones[0] < 5200);
+    EPIDESIM_CHECK(ones[1] > 4800 && ones[1] < 5200);
+    agent_engine<Bijection> engine(rng, 9, 4);
+    EPIDESIM_CHECK(engine() == rng.bits(9, 4) && engine() == rng.bits(9, 5));
+    engine.discard(3);
+    EPIDESIM_CHECK(engine.draws() == 9 && engine() == rng.bits(9, 9));
+    std::uniform_int_distribution<int> dice(1, 6);
+    const int roll = dice(engine);
+    EPIDESIM_CHECK(roll >= 1 && roll <= 6);
+}
+
+// Checks the known answers of the bijections and both generators
+void test_counter_based_rng() {
+    constexpr philox4x32::counter_type philox = philox4x32::generate(
+        {0, 0, 0, 0},
+        {0, 0}
+    );
+    static_assert(philox[0] == 0x6627E8D5 && philox[1] == 0xE169C58D);
+    static_assert(philox[2] == 0xBC57AC4C && philox[3] == 0x9B00DBD8);
+    constexpr threefry4x32::counter_type threefry = threefry4x32::generate(
+        {0, 0, 0, 0},
+        {0, 0}
+    );
+    static_assert(threefry[0] == 0x9C6CA96A && threefry[1] == 0xE17EAE66);
+    static_assert(threefry[2] == 0xFC10ECD4 && threefry[3] == 0x5256A7D8);
+    check_counter_based_rng<philox4x32>();
+    check_counter_based_rng<threefry4x32>();
+}
+
+// Checks that uniforms stay in the open unit interval
+void test_to_uniform() {
+    using rng_type = counter_based_rng<>;
+    constexpr std::uint32_t max = std::numeric_limits<std::uint32_t>::max();
+    for (std::uint32_t word: {0U, 1U, 255U, max - 255, max - 127, max}) {
+        const float single = rng_type::to_uniform<float>(word);
+        const double real = rng_type::to_uniform<double>(word);
+        EPIDESIM_CHECK(single > 0.f && single < 1.f);
+        EPIDESIM_CHECK(real > 0. && real < 1.);
+        EPIDESIM_CHECK(std::isfinite(std::log(1.f - single)));
+        EPIDESIM_CHECK(std::isfinite(std::log(single)));
+    }
+    EPIDESIM_CHECK(rng_type::to_uniform<double>(0) == 0.5 / 4294967296.);
+    EPIDESIM_CHECK(rng_type::to_uniform<float>(1U << 31) > 0.5f);
+    EPIDESIM_CHECK(rng_type::to_uniform<float>((1U << 31) - 1) < 0.5f);
+}
+// ========================================================================== //
+
+
+
+// ================================== MAIN ================================== //
+// Runs the tests
+int main() {
+    test_counter_based_rng();
+    test_to_uniform();
+    return test_result();
+}
+// ========================================================================== //
@@ -0,0 +1,154 @@
+// =============================== REDUCTIONS =============================== //
+// Project:         epidesim
+// Name:            reductions.cpp
+// Description:     Tests of the column reductions
+// Creator:         Vincent Reverdy
+// Contributor(s):  Vincent Reverdy [2020-]
+// License:         BSD 3-Clause License
+// ========================================================================== //
+
+
+
+// ============================== PREAMBLE ================================== //
+// C++ standard library
+#include <array>
+#include <cmath>
+#include <random>
+#include <vector>
+#include <cstdint>
+#include <type_traits>
+// Project sources
+#include "reductions.hpp"
+#include "testing.hpp"
+// Third-party libraries
+// Miscellaneous
+using namespace epidesim;
+// ========================================================================== //
+
+
+
+// ============================== COLUMN SUM ================================ //
+// Checks that sums default to the type of floating point values and to wide
+// integers for integral values
+void test_column_sum() {
+    std::mt19937 engine(3);
+    std::uniform_real_distribution<double> real(-1, 1);
+    std::vector<double> doubles(1003);
+    std::vector<float> floats(1003);
+    std::vector<std::uint8_t> bytes(100003);
+    std::vector<int> ints(1003);
+    double expected = 0;
+    long integers = 0;
+    std::uint64_t small = 0;
+    for (std::size_t i = 0; i < doubles.size(); ++i) {
+        doubles[i] = real(engine);
+        floats[i] = static_cast<float>(doubles[i]);
+        ints[i] = static_cast<int>(doubles[i] * 1000);
+        expected += doubles[i];
+        integers += ints[i];
+    }
+    for (std::size_t i = 0; i < bytes.size(); ++i) {
+        bytes[i] = static_cast<std::uint8_t>(engine());
+        small += bytes[i];
+    }
+    static_assert(std::is_same_v<decltype(column_sum(doubles)), double>);
+    static_assert(std::is_same_v<decltype(column_sum(floats)), float>);
+    static_assert(std::is_same_v<decltype(column_sum(ints)), std::int64_t>);
+    static_assert(std::is_same_v<decltype(column_sum(bytes)), std::uint64_t>);
+    static_assert(std::is_same_v<decltype(column_sum<int>(bytes)), int>);
+    EPIDESIM_CHECK(std::abs(column_sum(doubles) - expected) < 1e-9);
+    EPIDESIM_CHECK(std::abs(column_sum(floats) - expected) < 1e-3);
+    EPIDESIM_CHECK(column_sum(ints) == integers);
+    EPIDESIM_CHECK(column_sum(bytes) == small);
+    EPIDESIM_CHECK(column_sum(doubles.data(), 0) == 0);
+    using states = nttp_pack<0, 1, 10>;
+    compartment_column<states> column;
+    for (int i = 0; i < 300; ++i) {
+        column.push_back(i % 3 == 2 ? 10 : i % 3);
+    }
+    static_assert(std::is_same_v<decltype(column_sum(column)), std::int64_t>);
+    EPIDESIM_CHECK(column_sum(column) == 1100);
+    EPIDESIM_CHECK(column_sum<double>(column) == 1100.);
+}
+// ========================================================================== //
+
+
+
+// ======================= COLUMN COUNT, MIN AND MAX ======================== //
+// Checks counts, extrema and histograms against scalar loops
+void test_column_count() {
+    std::mt19937 engine(5);
+    std::vector<std::uint8_t> bytes(4099);
+    std::vector<double> doubles(1001);
+    std::size_t ones = 0;
+    for (std::uint8_t& byte: bytes) {
+        byte = static_cast<std::uint8_t>(engine() % 4);
+        ones += byte == 1;
+    }
+    double minimum = 1;
+    double maximum = 0;
+    for (double& value: doubles) {
+        value = std::uniform_real_distribution<double>(0, 1)(engine);
+        minimum = std::min(minimum, value);
+        maximum = std::max(maximum, value);
+    }
+    EPIDESIM_CHECK(column_count(bytes, 1) == ones);
+    EPIDESIM_CHECK(column_count(bytes.data(), bytes.size(), 1) == ones);
+    EPIDESIM_CHECK(column_count(doubles, doubles[7]) >= 1);
+    EPIDESIM_CHECK(column_min(doubles) == minimum);
+    EPIDESIM_CHECK(column_max(doubles) == maximum);
+    EPIDESIM_CHECK(column_min(bytes) == 0 && column_max(bytes) == 3);
+    const auto histogram = column_histogram<nttp_pack<0, 1, 2, 3>>(bytes);
+    EPIDESIM_CHECK(histogram[1] == ones);
+    EPIDESIM_CHECK(
+        histogram[0] + histogram[1] + histogram[2] + histogram[3]
+        == bytes.size()
+    );
+    compartment_column<nttp_pack<0, 1, 2, 3>> column;
+    for (const std::uint8_t byte: bytes) {
+        column.push_back(byte);
+    }
+    EPIDESIM_CHECK(column_count(column, 1) == ones);
+    EPIDESIM_CHECK(column_histogram(column) == histogram);
+}
+
+// Checks single pass histograms against counts, across the vector remainders
+// and the flushes of the byte accumulators
+void test_column_histogram() {
+    using states = nttp_pack<0, 2, 3, 5, 7>;
+    constexpr std::array<int, 5> values = pack_values_v<states>;
+    std::mt19937 engine(7);
+    for (std::size_t size: {0, 1, 31, 33, 1000, 100003}) {
+        std::vector<std::uint8_t> bytes(size);
+        std::vector<int> ints(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            bytes[i] = static_cast<std::uint8_t>(engine() % 6);
+            ints[i] = bytes[i];
+        }
+        const auto byte_histogram = column_histogram<states>(bytes);
+        const auto int_histogram = column_histogram<states>(ints);
+        bool valid = true;
+        for (std::size_t s = 0; s < values.size(); ++s) {
+            const std::size_t expected = column_count(
+                bytes,
+                static_cast<std::uint8_t>(values[s])
+            );
+            valid = valid && byte_histogram[s] == expected;
+            valid = valid && int_histogram[s] == expected;
+        }
+        EPIDESIM_CHECK(valid && byte_histogram[4] == 0);
+    }
+}
+// ========================================================================== //
+
+
+
+// ================================== MAIN ================================== //
+// Runs the tests
+int main() {
+    test_column_sum();
+    test_column_count();
+    test_column_histogram();
+    return test_result();
+}
+// ========================================================================== //
@@ -0,0 +1,273 @@
+// ================================ SAMPLERS ================================ //
+// Project:         epidesim
+// Name:            samplers.cpp
+// Description:     Statistical tests of the batched samplers
+// Creator:         Vincent Reverdy
+// Contributor(s):  Vincent Reverdy [2020-]
+// License:         BSD 3-Clause License
+// ========================================================================== //
+
+
+
+// ============================== PREAMBLE ================================== //
+// C++ standard library
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+// Project sources
+#include "samplers.hpp"
+#include "testing.hpp"
+// Third-party libraries
+// Miscellaneous
+using namespace epidesim;
+// ========================================================================== //
+
+
+
+// ============================== STATISTICS ================================ //
+// Returns the chi-square value above which a fit is rejected at the 0.1%
+// level, by the approximation of Wilson and Hilferty
+double chi_square_bound(std::size_t freedom) {
+    const double k = static_cast<double>(freedom);
+    const double z = 3.0902;
+    return k * std::pow(1 - 2 / (9 * k) + z * std::sqrt(2 / (9 * k)), 3);
+}
+
+// Returns the Kolmogorov-Smirnov value above which a fit is rejected at the
+// 0.1% level, for a sample of the given size
+double kolmogorov_smirnov_bound(std::size_t size) {
+    return 1.9495 / std::sqrt(static_cast<double>(size));
+}
+
+// Checks the fit of counts to a distribution given by its probabilities,
+// merging the categories with less than five expected observations
+bool chi_square_fit(
+    const std::vector<std::size_t>& counts,
+    const std::vector<double>& probabilities
+) {
+    double total = 0;
+    for (std::size_t count: counts) {
+        total += static_cast<double>(count);
+    }
+    double statistic = 0;
+    double observed = 0;
+    double expected = 0;
+    std::size_t categories = 0;
+    for (std::size_t i = 0; i < counts.size(); ++i) {
+        observed += static_cast<double>(counts[i]);
+        expected += probabilities[i] * total;
+        if (expected >= 5 || i + 1 == counts.size()) {
+            statistic += (observed - expected) * (observed - expected)
+            / std::max(expected, 1.);
+            observed = 0;
+            expected = 0;
+            ++categories;
+        }
+    }
+    return categories > 1 && statistic < chi_square_bound(categories - 1);
+}
+
+// Checks the fit of values to a continuous distribution function
+template <class Real, class Distribution>
+bool kolmogorov_smirnov_fit(
+    std::vector<Real> values,
+    Distribution&& distribution
+) {
+    std::sort(values.begin(), values.end());
+    const double size = static_cast<double>(values.size());
+    double statistic = 0;
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        const double cdf = distribution(static_cast<double>(values[i]));
+        statistic = std::max({
+            statistic,
+            cdf - static_cast<double>(i) / size,
+            static_cast<double>(i + 1) / size - cdf
+        });
+    }
+    return statistic < kolmogorov_smirnov_bound(values.size());
+}
+// ========================================================================== //
+
+
+
+// ============================ SAMPLER KERNELS ============================= //
+// Checks the thresholds and the branch-free logarithm
+void test_sampler_kernels() {
+    EPIDESIM_CHECK(sampler_kernels::threshold(-0.5) == 0);
+    EPIDESIM_CHECK(sampler_kernels::threshold(0.) == 0);
+    EPIDESIM_CHECK(sampler_kernels::threshold(0.5) == std::uint64_t(1) << 31);
+    EPIDESIM_CHECK(sampler_kernels::threshold(1.) == std::uint64_t(1) << 32);
+    EPIDESIM_CHECK(sampler_kernels::threshold(2.f) == std::uint64_t(1) << 32);
+    EPIDESIM_CHECK(sampler_kernels::parameter(0.25, 7) == 0.25);
+    EPIDESIM_CHECK(sampler_kernels::parameter(std::vector{1, 2, 3}, 2) == 3);
+    double single = 0;
+    double real = 0;
+    for (double x = 1e-30; x < 1e30; x *= 1.37) {
+        const double reference = std::log(x);
+        const double tolerance = std::max(1., std::abs(reference));
+        single = std::max(single, std::abs(
+            sampler_kernels::log(static_cast<float>(x))
+            - std::log(static_cast<float>(x))
+        ) / tolerance);
+        real = std::max(
+            real,
+            std::abs(sampler_kernels::log(x) - reference) / tolerance
+        );
+    }
+    EPIDESIM_CHECK(single < 1e-6 && real < 1e-14);
+    EPIDESIM_CHECK(sampler_kernels::log(1.) == 0.);
+}
+// ========================================================================== //
+
+
+
+// ============================ BERNOULLI SAMPLER =========================== //
+// Checks the masks of Bernoulli trials against the raw bits and their counts
+// against the binomial distribution, for shared and per-agent probabilities
+void test_sample_bernoulli() {
+    constexpr std::size_t count = 100000;
+    const counter_based_rng<> rng(42, 1, 2);
+    std::vector<std::uint64_t> mask;
+    const std::size_t successes = sample_bernoulli(rng, 3, count, 0.3, mask);
+    bool consistent = mask.size() == (count + 63) / 64;
+    std::size_t ones = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        const bool bit = (mask[i / 64] >> (i % 64)) & 1;
+        const std::uint32_t agent = static_cast<std::uint32_t>(3 + i);
+        consistent = consistent
+        && bit == (rng.bits(agent) < sampler_kernels::threshold(0.3));
+        ones += bit;
+    }
+    EPIDESIM_CHECK(consistent && ones == successes);
+    EPIDESIM_CHECK(mask.back() >> (count % 64) == 0);
+    EPIDESIM_CHECK(chi_square_fit({count - successes, successes}, {0.7, 0.3}));
+    std::vector<float> probabilities(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        probabilities[i] = static_cast<float>(i % 4) / 4;
+    }
+    sample_bernoulli(rng, 0, count, probabilities, mask, 5);
+    std::vector<std::size_t> classes(8);
+    for (std::size_t i = 0; i < count; ++i) {
+        ++classes[2 * (i % 4) + ((mask[i / 64] >> (i % 64)) & 1)];
+    }
+    EPIDESIM_CHECK(classes[1] == 0);
+    bool fitted = true;
+    for (std::size_t i = 1; i < 4; ++i) {
+        const double p = static_cast<double>(i) / 4;
+        fitted = fitted && chi_square_fit(
+            {classes[2 * i], classes[2 * i + 1]},
+            {1 - p, p}
+        );
+    }
+    EPIDESIM_CHECK(fitted);
+    EPIDESIM_CHECK(sample_bernoulli(rng, 0, count, 1., mask) == count);
+    EPIDESIM_CHECK(sample_bernoulli(rng, 0, count, 0., mask) == 0);
+}
+// ========================================================================== //
+
+
+
+// =========================== EXPONENTIAL SAMPLER ========================== //
+// Checks the dwell times against the exponential distribution function, for
+// shared and per-agent rates
+template <class Real>
+void check_sample_exponential() {
+    constexpr std::size_t count = 100000;
+    const counter_based_rng<> rng(7, 3);
+    std::vector<Real> times(count);
+    sample_exponential(rng, 11, 0.5, times);
+    const bool positive = std::all_of(times.begin(), times.end(), [](Real x){
+        return x > 0 && std::isfinite(x);
+    });
+    EPIDESIM_CHECK(positive);
+    EPIDESIM_CHECK(kolmogorov_smirnov_fit(times, [](double x){
+        return 1 - std::exp(-0.5 * x);
+    }));
+    std::vector<double> rates(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        rates[i] = static_cast<double>(i % 3 + 1);
+    }
+    sample_exponential(rng, 0, rates, times, 1);
+    for (std::size_t i = 0; i < count; ++i) {
+        times[i] *= static_cast<Real>(rates[i]);
+    }
+    EPIDESIM_CHECK(kolmogorov_smirnov_fit(times, [](double x){
+        return 1 - std::exp(-x);
+    }));
+}
+
+// Checks the dwell times in both precisions
+void test_sample_exponential() {
+    check_sample_exponential<float>();
+    check_sample_exponential<double>();
+}
+// ========================================================================== //
+
+
+
+// ============================ BINOMIAL SAMPLER ============================ //
+// Checks the variates of the given parameters against the binomial
+// distribution, through both overloads
+void check_sample_binomial(std::uint32_t trials, double probability) {
+    constexpr std::size_t count = 100000;
+    const counter_based_rng<> rng(trials, 5, 1);
+    std::vector<std::uint32_t> variates(count);
+    sample_binomial(rng, 0, trials, probability, variates);
+    std::vector<std::size_t> counts(trials + 1);
+    bool bounded = true;
+    for (std::uint32_t variate: variates) {
+        bounded = bounded && variate <= trials;
+        ++counts[std::min(variate, trials)];
+    }
+    std::vector<double> probabilities(trials + 1);
+    for (std::uint32_t k = 0; k <= trials; ++k) {
+        probabilities[k] = std::exp(
+            std::lgamma(trials + 1.) - std::lgamma(k + 1.)
+            - std::lgamma(trials - k + 1.)
+            + k * std::log(probability)
+            + (trials - k) * std::log1p(-probability)
+        );
+    }
+    EPIDESIM_CHECK(bounded && chi_square_fit(counts, probabilities));
+    std::vector<std::uint64_t> repeated(16);
+    sample_binomial(rng, 0, 16, trials, probability, repeated.data());
+    EPIDESIM_CHECK(std::equal(
+        repeated.begin(),
+        repeated.end(),
+        variates.begin()
+    ));
+}
+
+// Checks the inversion branch below a mean of thirty and the rejection
+// branch above, with probabilities on both sides of one half
+void test_sample_binomial() {
+    check_sample_binomial(20, 0.3);
+    check_sample_binomial(100, 0.8);
+    check_sample_binomial(500, 0.05);
+    check_sample_binomial(1000, 0.2);
+    check_sample_binomial(200, 0.75);
+    check_sample_binomial(100000, 0.5);
+    const counter_based_rng<> rng(1);
+    std::vector<int> variates(4);
+    const std::vector<int> trials = {0, 5, 5, 5};
+    const std::vector<double> probabilities = {0.5, 0., 1., 0.5};
+    sample_binomial(rng, 0, trials, probabilities, variates);
+    EPIDESIM_CHECK(variates[0] == 0 && variates[1] == 0 && variates[2] == 5);
+    EPIDESIM_CHECK(variates[3] >= 0 && variates[3] <= 5);
+}
+// ========================================================================== //
+
+
+
+// ================================== MAIN ================================== //
+// Runs the tests
+int main() {
+    test_sampler_kernels();
+    test_sample_bernoulli();
+    test_sample_exponential();
+    test_sample_binomial();
+    return test_result();
+}
+// ========================================================================== //
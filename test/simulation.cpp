@@ -0,0 +1,194 @@
+// =============================== SIMULATION =============================== //
+// Project:         epidesim
+// Name:            simulation.cpp
+// Description:     Tests of the tick-based simulation engine
+// Creator:         Vincent Reverdy
+// Contributor(s):  Vincent Reverdy [2020-]
+// License:         BSD 3-Clause License
+// ========================================================================== //
+
+
+
+// ============================== PREAMBLE ================================== //
+// C++ standard library
+#include <vector>
+#include <cstdint>
+#include <type_traits>
+// Project sources
+#include "parallel.hpp"
+#include "simulation.hpp"
+#include "testing.hpp"
+// Third-party libraries
+// Miscellaneous
+using namespace epidesim;
+// ========================================================================== //
+
+
+
+// ============================ SCHEMA PARTITION ============================ //
+// Attributes of the tested schemas
+struct age {
+    float years;
+};
+struct compartment {
+    std::uint8_t code;
+};
+using schema = type_pack<
+    age,
+    double_buffered<compartment>,
+    double_buffered<int>
+>;
+
+// Checks the split of schemas into constant and double buffered attributes
+void test_schema_partition() {
+    static_assert(is_double_buffered_v<double_buffered<int>>);
+    static_assert(!is_double_buffered_v<int>);
+    static_assert(std::is_same_v<
+        remove_double_buffered_t<double_buffered<age>>,
+        age
+    >);
+    static_assert(std::is_same_v<remove_double_buffered_t<age>, age>);
+    static_assert(std::is_same_v<
+        schema_partition<schema>::constant_type,
+        type_pack<age>
+    >);
+    static_assert(std::is_same_v<
+        schema_partition<schema>::mutable_type,
+        type_pack<compartment, int>
+    >);
+    static_assert(std::is_same_v<
+        schema_partition<type_pack<>>::mutable_type,
+        type_pack<>
+    >);
+    EPIDESIM_CHECK(pack_size_v<schema_partition<schema>::constant_type> == 1);
+}
+// ========================================================================== //
+
+
+
+// =============================== SIMULATION =============================== //
+// Checks the storage of constant and double buffered columns
+void test_simulation_columns() {
+    using simulation_type = simulation<schema>;
+    simulation_type simulation(100);
+    EPIDESIM_CHECK(!simulation.empty() && simulation.size() == 100);
+    EPIDESIM_CHECK(simulation.tick() == 0);
+    EPIDESIM_CHECK(simulation.column<age>().size() == 100);
+    EPIDESIM_CHECK(simulation.column<int>().size() == 100);
+    EPIDESIM_CHECK(&simulation.column<int>() != &simulation.next_column<int>());
+    EPIDESIM_CHECK(
+        &simulation.column<int>() == &simulation.current().column<int>()
+    );
+    EPIDESIM_CHECK(
+        &simulation.column<age>() == &simulation.constants().column<age>()
+    );
+    std::size_t stores = 0;
+    simulation.for_each_store([&stores](auto& store) {
+        stores += store.size() == 100;
+    });
+    EPIDESIM_CHECK(stores == 3);
+    simulation.resize(10);
+    EPIDESIM_CHECK(simulation.next_column<compartment>().size() == 10);
+}
+
+// Checks that kernels read the state of the previous tick, that unwritten
+// attributes are carried over, and that ticks are counted
+void test_simulation_step() {
+    simulation<schema> simulation(1000);
+    for (std::size_t i = 0; i < simulation.size(); ++i) {
+        simulation.column<age>()[i].years = static_cast<float>(i);
+        simulation.column<compartment>()[i].code = i % 2;
+        simulation.column<int>()[i] = static_cast<int>(i);
+    }
+    const auto kernel = [](const auto& frame, std::size_t i) {
+        const int next = frame.template get<int>((i + 1) % frame.size());
+        frame.template set<int>(i, next);
+        if (frame.tick() % 2 && frame.template get<age>(i).years < 10) {
+            frame.template set<compartment>(i, compartment{7});
+        }
+    };
+    simulation.step(kernel);
+    EPIDESIM_CHECK(simulation.tick() == 1);
+    EPIDESIM_CHECK(simulation.column<int>()[999] == 0);
+    EPIDESIM_CHECK(simulation.column<compartment>()[3].code == 1);
+    simulation.run(4, kernel);
+    bool shifted = true;
+    std::size_t changed = 0;
+    for (std::size_t i = 0; i < simulation.size(); ++i) {
+        shifted = shifted
+        && simulation.column<int>()[i] == static_cast<int>((i + 5) % 1000);
+        changed += simulation.column<compartment>()[i].code == 7;
+    }
+    EPIDESIM_CHECK(simulation.tick() == 5 && shifted && changed == 10);
+}
+
+// Checks that parallel steps give the same state as serial ones
+void test_simulation_parallel() {
+    simulation<schema> serial(100000);
+    simulation<schema> parallel(100000);
+    for (std::size_t i = 0; i < serial.size(); ++i) {
+        serial.column<int>()[i] = static_cast<int>(i * 7 % 1009);
+        parallel.column<int>()[i] = static_cast<int>(i * 7 % 1009);
+    }
+    const auto kernel = [](const auto& frame, std::size_t i) {
+        const std::size_t size = frame.size();
+        frame.template set<int>(
+            i,
+            frame.template get<int>((i + size - 1) % size)
+            ^ frame.template get<int>((i + 1) % size)
+            ^ static_cast<int>(frame.tick())
+        );
+    };
+    thread_pool pool(4);
+    sequential_executor sequential;
+    serial.run(12, kernel);
+    parallel.run(pool, 5, kernel);
+    parallel.run(pool, 5, 100, kernel);
+    parallel.step(sequential, kernel);
+    parallel.step(pool, 1, kernel);
+    EPIDESIM_CHECK(parallel.tick() == 12);
+    EPIDESIM_CHECK(serial.column<int>() == parallel.column<int>());
+}
+
+// Checks that parallel steps carry unwritten attributes over across the
+// blocks of the copy, including columns packing several agents per word
+void test_simulation_parallel_copy() {
+    using flags = type_pack<double_buffered<bool>, double_buffered<int>>;
+    using simulation_type = simulation<flags>;
+    const std::size_t size = 5 * simulation_type::copy_chunk + 77;
+    simulation_type serial(size);
+    simulation_type parallel(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        serial.column<bool>()[i] = i % 5 == 0;
+        parallel.column<bool>()[i] = i % 5 == 0;
+        serial.column<int>()[i] = static_cast<int>(i);
+        parallel.column<int>()[i] = static_cast<int>(i);
+    }
+    const auto kernel = [](const auto& frame, std::size_t i) {
+        if (i % 3 == frame.tick() % 3) {
+            frame.template set<bool>(i, !frame.template get<bool>(i));
+            frame.template set<int>(i, frame.template get<int>(i) + 1);
+        }
+    };
+    thread_pool pool(4);
+    serial.run(7, kernel);
+    parallel.run(pool, 7, 64, kernel);
+    EPIDESIM_CHECK(serial.column<bool>() == parallel.column<bool>());
+    EPIDESIM_CHECK(serial.column<int>() == parallel.column<int>());
+    EPIDESIM_CHECK(parallel.column<int>()[size - 1] == int(size - 1) + 3);
+}
+// ========================================================================== //
+
+
+
+// ================================== MAIN ================================== //
+// Runs the tests
+int main() {
+    test_schema_partition();
+    test_simulation_columns();
+    test_simulation_step();
+    test_simulation_parallel();
+    test_simulation_parallel_copy();
+    return test_result();
+}
+// ========================================================================== //
@@ -0,0 +1,196 @@
+// ================================ SPATIAL ================================= //
+// Project:         epidesim
+// Name:            spatial.cpp
+// Description:     Tests of the cell lists
+// Creator:         Vincent Reverdy
+// Contributor(s):  Vincent Reverdy [2020-]
+// License:         BSD 3-Clause License
+// ========================================================================== //
+
+
+
+// ============================== PREAMBLE ================================== //
+// C++ standard library
+#include <set>
+#include <cmath>
+#include <mutex>
+#include <limits>
+#include <random>
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+// Project sources
+#include "spatial.hpp"
+#include "parallel.hpp"
+#include "testing.hpp"
+// Third-party libraries
+// Miscellaneous
+using namespace epidesim;
+// ========================================================================== //
+
+
+
+// ================================ CELL LIST =============================== //
+// Returns random coordinates drawn uniformly over a square domain
+std::vector<double> random_coordinates(
+    std::size_t size,
+    double extent,
+    std::uint32_t seed
+) {
+    std::mt19937 engine(seed);
+    std::uniform_real_distribution<double> distribution(0, extent);
+    std::vector<double> result(size);
+    for (double& value: result) {
+        value = distribution(engine);
+    }
+    return result;
+}
+
+// Checks the cells of positions inside, outside and away from the domain
+void test_cell_list_locate() {
+    constexpr double nan = std::numeric_limits<double>::quiet_NaN();
+    constexpr double infinity = std::numeric_limits<double>::infinity();
+    const cell_list<double> cells(1.0, 0.0, 0.0, 4.0, 3.0);
+    EPIDESIM_CHECK(cells.columns() == 4 && cells.rows() == 3);
+    EPIDESIM_CHECK(cells.cells() == 12 && cells.side() == 1.0);
+    EPIDESIM_CHECK(cells.locate(0.5, 0.5) == 0);
+    EPIDESIM_CHECK(cells.locate(3.5, 0.5) == 3);
+    EPIDESIM_CHECK(cells.locate(1.5, 2.5) == 9);
+    EPIDESIM_CHECK(cells.locate(-7.0, 1.5) == 4);
+    EPIDESIM_CHECK(cells.locate(9.0, 9.0) == 11);
+    EPIDESIM_CHECK(cells.locate(-infinity, infinity) == 8);
+    EPIDESIM_CHECK(cells.locate(infinity, -infinity) == 3);
+    EPIDESIM_CHECK(cells.locate(1e300, 1e300) == 11);
+    EPIDESIM_CHECK(cells.locate(nan, 1.5) == 4);
+    EPIDESIM_CHECK(cells.locate(2.5, nan) == 2);
+    EPIDESIM_CHECK(cells.locate(nan, nan) == 0);
+}
+
+// Checks that agents are listed by cell in increasing order, and that the
+// sort is skipped when no agent changed cell
+void test_cell_list_update() {
+    constexpr std::size_t size = 20000;
+    std::vector<double> x = random_coordinates(size, 50.0, 1);
+    std::vector<double> y = random_coordinates(size, 50.0, 2);
+    x[7] = std::numeric_limits<double>::quiet_NaN();
+    y[8] = std::numeric_limits<double>::infinity();
+    cell_list<double> cells(2.0, 0.0, 0.0, 50.0, 50.0);
+    EPIDESIM_CHECK(cells.empty());
+    EPIDESIM_CHECK(cells.update(x, y) == size);
+    EPIDESIM_CHECK(cells.size() == size && cells.agents().size() == size);
+    EPIDESIM_CHECK(cells.offsets().size() == cells.cells() + 1);
+    EPIDESIM_CHECK(cells.offsets().back() == size);
+    bool valid = true;
+    for (std::size_t cell = 0; cell < cells.cells(); ++cell) {
+        const auto agents = cells.agents(cell);
+        valid = valid && std::is_sorted(agents.begin(), agents.end());
+        for (const std::uint32_t agent: agents) {
+            valid = valid && cells.cell(agent) == cell;
+            valid = valid && cells.locate(x[agent], y[agent]) == cell;
+        }
+    }
+    EPIDESIM_CHECK(valid);
+    EPIDESIM_CHECK(cells.cell(7) % cells.columns() == 0);
+    EPIDESIM_CHECK(cells.cell(8) / cells.columns() == cells.rows() - 1);
+    const std::vector<std::uint32_t> agents = cells.agents();
+    x[3] += 1e-9;
+    EPIDESIM_CHECK(cells.update(x, y) == 0 && cells.agents() == agents);
+    x[3] = x[3] < 25.0 ? 49.0 : 1.0;
+    EPIDESIM_CHECK(cells.update(x, y) == 1);
+    EPIDESIM_CHECK(cells.cell(3) == cells.locate(x[3], y[3]));
+    x.resize(size / 2);
+    y.resize(size / 2);
+    EPIDESIM_CHECK(cells.update(x, y) == 0 && cells.size() == size / 2);
+    EPIDESIM_CHECK(cells.offsets().back() == size / 2);
+}
+
+// Checks that the parallel update lists the agents as the serial update
+void test_cell_list_parallel_update() {
+    thread_pool pool(4);
+    for (std::size_t size: {0, 100, 5000, 100000}) {
+        const std::vector<double> x = random_coordinates(size, 100.0, 3);
+        const std::vector<double> y = random_coordinates(size, 100.0, 4);
+        cell_list<double> serial(1.0, 0.0, 0.0, 100.0, 100.0);
+        cell_list<double> parallel(1.0, 0.0, 0.0, 100.0, 100.0);
+        EPIDESIM_CHECK(serial.update(x, y) == parallel.update(pool, x, y));
+        EPIDESIM_CHECK(serial.agents() == parallel.agents());
+        EPIDESIM_CHECK(serial.offsets() == parallel.offsets());
+        const std::vector<double> z = random_coordinates(size, 100.0, 5);
+        EPIDESIM_CHECK(serial.update(z, y) == parallel.update(pool, z, y));
+        EPIDESIM_CHECK(serial.agents() == parallel.agents());
+        EPIDESIM_CHECK(serial.offsets() == parallel.offsets());
+    }
+}
+
+// Checks the neighborhoods and the contacts against all pairs of agents
+void test_cell_list_contacts() {
+    constexpr std::size_t size = 3000;
+    constexpr double radius = 1.5;
+    const std::vector<double> x = random_coordinates(size, 30.0, 6);
+    const std::vector<double> y = random_coordinates(size, 30.0, 7);
+    cell_list<double> cells(2.0, 0.0, 0.0, 30.0, 30.0);
+    cells.update(x, y);
+    std::set<std::pair<std::uint32_t, std::uint32_t>> expected;
+    for (std::uint32_t i = 0; i < size; ++i) {
+        for (std::uint32_t j = i + 1; j < size; ++j) {
+            const double dx = x[i] - x[j];
+            const double dy = y[i] - y[j];
+            if (dx * dx + dy * dy <= radius * radius) {
+                expected.emplace(i, j);
+            }
+        }
+    }
+    std::set<std::pair<std::uint32_t, std::uint32_t>> serial;
+    cells.contacts(x, y, radius, [&](std::uint32_t i, std::uint32_t j) {
+        serial.emplace(i, j);
+    });
+    EPIDESIM_CHECK(!expected.empty() && serial == expected);
+    thread_pool pool(4);
+    std::mutex mutex;
+    std::set<std::pair<std::uint32_t, std::uint32_t>> parallel;
+    cells.contacts(pool, x, y, radius, [&](std::uint32_t i, std::uint32_t j) {
+        std::lock_guard<std::mutex> lock(mutex);
+        parallel.emplace(i, j);
+    });
+    EPIDESIM_CHECK(parallel == expected);
+    bool valid = true;
+    for (std::uint32_t agent = 0; agent < size; ++agent) {
+        std::size_t count = 0;
+        for (const std::uint32_t other: cells.neighbors_of(agent)) {
+            const auto row = [&cells](std::uint32_t i) {
+                return cells.cell(i) / cells.columns();
+            };
+            const auto column = [&cells](std::uint32_t i) {
+                return cells.cell(i) % cells.columns();
+            };
+            valid = valid && row(other) + 1 >= row(agent);
+            valid = valid && row(other) <= row(agent) + 1;
+            valid = valid && column(other) + 1 >= column(agent);
+            valid = valid && column(other) <= column(agent) + 1;
+            ++count;
+        }
+        const auto neighbors = cells.neighbors_of(agent);
+        valid = valid
+        && static_cast<std::size_t>(std::distance(
+            neighbors.begin(),
+            neighbors.end()
+        )) == count;
+    }
+    EPIDESIM_CHECK(valid);
+}
+// ========================================================================== //
+
+
+
+// ================================== MAIN ================================== //
+// Runs the tests
+int main() {
+    test_cell_list_locate();
+    test_cell_list_update();
+    test_cell_list_parallel_update();
+    test_cell_list_contacts();
+    return test_result();
+}
+// ========================================================================== //
@@ -0,0 +1,146 @@
+// ================================= STORES ================================= //
+// Project:         epidesim
+// Name:            stores.cpp
+// Description:     Tests of the agent stores
+// Creator:         Vincent Reverdy
+// Contributor(s):  Vincent Reverdy [2020-]
+// License:         BSD 3-Clause License
+// ========================================================================== //
+
+
+
+// ============================== PREAMBLE ================================== //
+// C++ standard library
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <type_traits>
+// Project sources
+#include "stores.hpp"
+#include "testing.hpp"
+// Third-party libraries
+// Miscellaneous
+using namespace epidesim;
+// ========================================================================== //
+
+
+
+// ================================ SOA STORE =============================== //
+// Attributes of the tested schemas
+struct age {
+    std::uint8_t value;
+};
+struct weight {
+    float value;
+};
+using schema = type_pack<age, weight, int>;
+
+// Checks that a structure of arrays stores one column per attribute
+void test_soa_store() {
+    using store_type = soa_store<schema>;
+    static_assert(store_type::columns() == 3);
+    static_assert(std::is_same_v<
+        std::remove_reference_t<decltype(store_type().column<1>())>,
+        std::vector<weight>
+    >);
+    static_assert(!is_pack_v<store_type>);
+    store_type store;
+    EPIDESIM_CHECK(store.empty() && store.size() == 0);
+    for (int i = 0; i < 100; ++i) {
+        store.push_back(
+            age{std::uint8_t(i)},
+            weight{float(i) / 2},
+            i * i
+        );
+    }
+    EPIDESIM_CHECK(store.size() == 100);
+    EPIDESIM_CHECK(store.column<age>().size() == 100);
+    EPIDESIM_CHECK(store.column<int>()[9] == 81);
+    EPIDESIM_CHECK(store.column<1>()[10].value == 5.f);
+    EPIDESIM_CHECK(&store.column<0>() == &store.column<age>());
+    store.value<int>(3) = -1;
+    EPIDESIM_CHECK(store.column<2>()[3] == -1);
+    EPIDESIM_CHECK(store.value<age>(42).value == 42);
+    std::size_t columns = 0;
+    std::size_t sizes = 0;
+    store.for_each_column([&](const auto& column) {
+        ++columns;
+        sizes += column.size();
+    });
+    EPIDESIM_CHECK(columns == 3 && sizes == 300);
+    store.pop_back();
+    EPIDESIM_CHECK(store.size() == 99);
+    store.resize(10);
+    EPIDESIM_CHECK(store.size() == 10 && store.column<weight>().size() == 10);
+    store.clear();
+    EPIDESIM_CHECK(store.empty());
+    static_assert(std::is_same_v<
+        agent_store_t<schema, soa_layout>,
+        store_type
+    >);
+    soa_store<type_pack<>> empty;
+    empty.reserve(10);
+    empty.resize(10);
+    EPIDESIM_CHECK(empty.empty() && soa_store<type_pack<>>::columns() == 0);
+}
+// ========================================================================== //
+
+
+
+// =============================== AOSOA STORE ============================== //
+// Checks that a tiled store keeps the values of a structure of arrays
+void test_aosoa_store() {
+    using store_type = aosoa_store<schema, size_constant<8>>;
+    using tile_type = store_type::tile_type;
+    static_assert(store_type::width() == 8 && store_type::columns() == 3);
+    static_assert(tile_type::width() == 8);
+    static_assert(std::is_same_v<
+        std::remove_reference_t<decltype(tile_type().lanes<int>())>,
+        std::array<int, 8>
+    >);
+    static_assert(std::is_same_v<
+        agent_store_t<schema, aosoa_layout<size_constant<8>>>,
+        store_type
+    >);
+    store_type store;
+    soa_store<schema> reference;
+    EPIDESIM_CHECK(store.empty() && store.tiles() == 0);
+    for (int i = 0; i < 101; ++i) {
+        store.push_back(age{std::uint8_t(i)}, weight{float(i)}, -i);
+        reference.push_back(age{std::uint8_t(i)}, weight{float(i)}, -i);
+    }
+    EPIDESIM_CHECK(store.size() == 101 && store.tiles() == 13);
+    bool same = true;
+    for (std::size_t i = 0; i < store.size(); ++i) {
+        same = same && store.value<age>(i).value == std::uint8_t(i);
+        same = same && store.value<weight>(i).value == float(i);
+        same = same && store.value<int>(i) == reference.value<int>(i);
+    }
+    EPIDESIM_CHECK(same);
+    EPIDESIM_CHECK(store.tile(2).lanes<int>()[3] == -19);
+    EPIDESIM_CHECK(&store.tile(2).lanes<2>() == &store.tile(2).lanes<int>());
+    store.value<int>(100) = 7;
+    EPIDESIM_CHECK(store.tile(12).lanes<int>()[4] == 7);
+    store.pop_back();
+    EPIDESIM_CHECK(store.size() == 100 && store.tiles() == 13);
+    for (int i = 0; i < 4; ++i) {
+        store.pop_back();
+    }
+    EPIDESIM_CHECK(store.size() == 96 && store.tiles() == 12);
+    store.resize(17);
+    EPIDESIM_CHECK(store.size() == 17 && store.tiles() == 3);
+    store.clear();
+    EPIDESIM_CHECK(store.empty() && store.tiles() == 0);
+}
+// ========================================================================== //
+
+
+
+// ================================== MAIN ================================== //
+// Runs the tests
+int main() {
+    test_soa_store();
+    test_aosoa_store();
+    return test_result();
+}
+// ========================================================================== //
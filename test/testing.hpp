@@ -0,0 +1,69 @@
+// ================================= TESTING ================================ //
+// Project:         epidesim
+// Name:            testing.hpp
+// Description:     Minimal checks shared by the tests
+// Creator:         Vincent Reverdy
+// Contributor(s):  Vincent Reverdy [2020-]
+// License:         BSD 3-Clause License
+// ========================================================================== //
+#ifndef _TESTING_HPP_INCLUDED
+#define _TESTING_HPP_INCLUDED
+// ========================================================================== //
+
+
+
+// ============================== PREAMBLE ================================== //
+// C++ standard library
+#include <cstdio>
+#include <cstdlib>
+// Project sources
+// Third-party libraries
+// Miscellaneous
+namespace epidesim {
+// ========================================================================== //
+
+
+
+// ================================= CHECKS ================================= //
+// Returns the number of failed checks of a test
+inline int& test_failures() noexcept {
+    static int count = 0;
+    return count;
+}
+
+// Reports a check, and counts it when it failed
+inline void test_check(
+    bool condition,
+    const char* expression,
+    const char* file,
+    int line
+) noexcept {
+    if (!condition) {
+        std::fprintf(
+            stderr, "%s:%d: check failed: %s\n", file, line, expression
+        );
+        ++test_failures();
+    }
+}
+
+// Returns the exit status of a test, after reporting its failures
+inline int test_result() noexcept {
+    if (test_failures() > 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", test_failures());
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+// Checks a condition without interrupting the test
+#define EPIDESIM_CHECK(...) ::epidesim::test_check( \
+    static_cast<bool>(__VA_ARGS__), #__VA_ARGS__, __FILE__, __LINE__ \
+)
+// ========================================================================== //
+
+
+
+// ========================================================================== //
+} // namespace epidesim
+#endif // _TESTING_HPP_INCLUDED
+// ========================================================================== //
@@ -0,0 +1,487 @@
+// ============================== TRANSMISSION ============================== //
+// Project:         epidesim
+// Name:            transmission.cpp
+// Description:     Tests of the transmission kernels
+// Creator:         Vincent Reverdy
+// Contributor(s):  Vincent Reverdy [2020-]
+// License:         BSD 3-Clause License
+// ========================================================================== //
+
+
+
+// ============================== PREAMBLE ================================== //
+// C++ standard library
+#include <cmath>
+#include <tuple>
+#include <random>
+#include <vector>
+#include <cstdint>
+#include <iterator>
+#include <algorithm>
+// Project sources
+#include "transmission.hpp"
+#include "graphs.hpp"
+#include "parallel.hpp"
+#include "testing.hpp"
+// Third-party libraries
+// Miscellaneous
+using namespace epidesim;
+// ========================================================================== //
+
+
+
+// ============================= AGENT FRONTIER ============================= //
+// Checks the list and the bitmap of a frontier, and the gathering of agents
+// marked by several workers
+void test_agent_frontier() {
+    agent_frontier frontier(1000);
+    EPIDESIM_CHECK(frontier.empty() && frontier.universe() == 1000);
+    EPIDESIM_CHECK(frontier.insert(7) && !frontier.insert(7));
+    EPIDESIM_CHECK(frontier.insert(999) && frontier.insert(64));
+    EPIDESIM_CHECK(frontier.size() == 3 && frontier.contains(64));
+    EPIDESIM_CHECK(!frontier.contains(63) && frontier.density() == 0.003);
+    EPIDESIM_CHECK(frontier.mark(3) && !frontier.mark(3));
+    frontier.collect();
+    EPIDESIM_CHECK(frontier.indices() == std::vector<std::uint32_t>({
+        3, 7, 64, 999
+    }));
+    EPIDESIM_CHECK(frontier.filter([](std::uint32_t i) {return i > 7;}) == 2);
+    EPIDESIM_CHECK(frontier.size() == 2 && frontier[0] == 64);
+    EPIDESIM_CHECK(!frontier.contains(3) && !frontier.contains(7));
+    frontier.clear();
+    EPIDESIM_CHECK(frontier.empty() && !frontier.contains(999));
+    for (std::uint32_t i = 0; i < 1000; i += 2) {
+        frontier.insert(i);
+    }
+    frontier.clear();
+    bool cleared = frontier.empty();
+    for (std::uint32_t i = 0; i < 1000; ++i) {
+        cleared = cleared && !frontier.contains(i);
+    }
+    EPIDESIM_CHECK(cleared);
+    frontier.insert(10);
+    frontier.insert(40);
+    frontier.prepare(3);
+    EPIDESIM_CHECK(frontier.mark(30, 2) && frontier.mark(5, 0));
+    EPIDESIM_CHECK(!frontier.mark(30, 1) && !frontier.mark(10, 1));
+    EPIDESIM_CHECK(frontier.mark(20, 1) && frontier.size() == 2);
+    frontier.gather();
+    EPIDESIM_CHECK(frontier.indices() == std::vector<std::uint32_t>({
+        5, 10, 20, 30, 40
+    }));
+    frontier.gather();
+    EPIDESIM_CHECK(frontier.size() == 5 && frontier.contains(20));
+}
+// ========================================================================== //
+
+
+
+// ========================== INFECTION PROPOSALS =========================== //
+// Checks that the earliest proposal of each target wins, ties being broken by
+// source, whatever the buffers holding the proposals
+void test_infection_proposals() {
+    thread_pool pool(4);
+    infection_proposals proposals;
+    infection_proposals::container_type winners;
+    proposals.prepare(pool.size());
+    EPIDESIM_CHECK(proposals.buffers() == 4 && proposals.empty());
+    proposals.buffer(0).push_back({5, 1, 0.5f});
+    proposals.buffer(1).push_back({5, 2, 0.25f});
+    proposals.buffer(2).push_back({9, 7, 0.5f});
+    proposals.buffer(3).push_back({9, 3, 0.5f});
+    proposals.buffer(3).push_back({0, 8, 0.75f});
+    EPIDESIM_CHECK(proposals.size() == 5);
+    EPIDESIM_CHECK(proposals.resolve(pool, 10, winners) == 3);
+    EPIDESIM_CHECK(winners[0].target == 0 && winners[0].source == 8);
+    EPIDESIM_CHECK(winners[1].target == 5 && winners[1].source == 2);
+    EPIDESIM_CHECK(winners[2].target == 9 && winners[2].source == 3);
+    std::mt19937 engine(4);
+    std::vector<infection> all;
+    for (std::size_t tick = 0; tick < 20; ++tick) {
+        proposals.prepare(pool.size());
+        EPIDESIM_CHECK(proposals.empty());
+        all.clear();
+        for (std::size_t i = 0; i < 100000; ++i) {
+            const infection proposal = {
+                static_cast<std::uint32_t>(engine() % 50000),
+                static_cast<std::uint32_t>(engine() % 1000),
+                static_cast<float>(engine() % 64) / 64
+            };
+            proposals.buffer(engine() % pool.size()).push_back(proposal);
+            all.push_back(proposal);
+        }
+        std::sort(all.begin(), all.end(), [](
+            const infection& lhs,
+            const infection& rhs
+        ) {
+            return std::tie(lhs.target, lhs.time, lhs.source)
+            < std::tie(rhs.target, rhs.time, rhs.source);
+        });
+        std::vector<infection> expected;
+        for (const infection& proposal: all) {
+            if (expected.empty() || expected.back().target != proposal.target) {
+                expected.push_back(proposal);
+            }
+        }
+        proposals.resolve(pool, 50000, winners);
+        bool equal = winners.size() == expected.size();
+        for (std::size_t i = 0; equal && i < winners.size(); ++i) {
+            equal = winners[i].target == expected[i].target
+            && winners[i].source == expected[i].source
+            && winners[i].time == expected[i].time;
+        }
+        EPIDESIM_CHECK(equal);
+    }
+    EPIDESIM_CHECK(proposals.buffers() == pool.size());
+    sequential_executor sequential;
+    proposals.prepare(sequential.size());
+    proposals.buffer(0).push_back({3, 1, 0.5f});
+    EPIDESIM_CHECK(proposals.resolve(sequential, 10, winners) == 1);
+}
+// ========================================================================== //
+
+
+
+// ========================== FRONTIER TRANSMISSION ========================= //
+// Layers of the tested graphs
+struct household {};
+struct workplace {};
+using graph_type = contact_graph<type_pack<household, workplace>, float>;
+using transmission_type = frontier_transmission<graph_type>;
+
+// Returns a random graph with pairs of agents in households and random
+// workplace contacts of various weights
+graph_type make_graph(std::size_t vertices) {
+    std::mt19937 engine(2);
+    std::vector<std::tuple<std::uint32_t, std::uint32_t, float>> households;
+    std::vector<std::tuple<std::uint32_t, std::uint32_t, float>> workplaces;
+    for (std::uint32_t i = 0; i < vertices; ++i) {
+        households.emplace_back(i, i ^ 1, 1.f);
+        for (std::size_t k = 0; k < 4; ++k) {
+            workplaces.emplace_back(
+                i,
+                engine() % vertices,
+                0.5f + 0.5f * (engine() % 2)
+            );
+        }
+    }
+    graph_type graph(vertices);
+    graph.assign<household>(households, true);
+    graph.assign<workplace>(workplaces, true);
+    return graph;
+}
+
+// Runs an epidemic with the given density threshold and returns the final
+// states of the agents, using frontiers or proposals
+template <class Executor>
+std::vector<std::uint8_t> run_epidemic(
+    Executor& executor,
+    const graph_type& graph,
+    double density,
+    bool proposing,
+    std::size_t& pulls
+) {
+    const std::size_t vertices = graph.vertices();
+    std::vector<std::uint8_t> states(vertices);
+    agent_frontier infectious(vertices);
+    agent_frontier infected(vertices);
+    infection_proposals proposals;
+    infection_proposals::container_type infections;
+    for (std::uint32_t i = 0; i < vertices; i += 997) {
+        states[i] = 1;
+        infectious.insert(i);
+    }
+    transmission_type transmission(
+        graph,
+        0.08,
+        transmission_type::all_layers,
+        density
+    );
+    const counter_based_rng<> rng(11, 0, 2);
+    for (std::uint32_t tick = 0; tick < 60; ++tick) {
+        if (proposing) {
+            transmission.step(
+                executor, states, 0, infectious, rng.at(tick),
+                proposals, infections
+            );
+            infected.clear();
+            for (const infection& event: infections) {
+                infected.insert(event.target);
+            }
+        } else {
+            infected.clear();
+            transmission.step(
+                executor, states, 0, infectious, rng.at(tick), infected
+            );
+        }
+        infectious.filter([&](std::uint32_t i) {
+            const bool recovering = rng.at(tick).with(0).uniform(i) < 0.15;
+            states[i] = recovering ? 2 : states[i];
+            return !recovering;
+        });
+        for (const std::uint32_t i: infected) {
+            states[i] = 1;
+            infectious.insert(i);
+        }
+    }
+    pulls = transmission.pulls();
+    EPIDESIM_CHECK(proposals.buffers() <= executor.size());
+    return states;
+}
+
+// Checks that pushing, pulling and switching between them give the same
+// epidemic, serially and in parallel, with frontiers and proposals
+void test_frontier_transmission() {
+    const graph_type graph = make_graph(20000);
+    thread_pool pool(4);
+    sequential_executor sequential;
+    std::size_t pulls = 0;
+    const std::vector<std::uint8_t> reference = run_epidemic(
+        sequential, graph, 2, false, pulls
+    );
+    EPIDESIM_CHECK(pulls == 0);
+    const std::size_t recovered = std::count(
+        reference.begin(),
+        reference.end(),
+        2
+    );
+    EPIDESIM_CHECK(recovered > 1000);
+    EPIDESIM_CHECK(run_epidemic(pool, graph, -1, false, pulls) == reference);
+    EPIDESIM_CHECK(pulls == 60);
+    EPIDESIM_CHECK(run_epidemic(pool, graph, 0.05, false, pulls) == reference);
+    EPIDESIM_CHECK(pulls > 0 && pulls < 60);
+    EPIDESIM_CHECK(run_epidemic(pool, graph, 2, true, pulls) == reference);
+    EPIDESIM_CHECK(run_epidemic(pool, graph, -1, true, pulls) == reference);
+    EPIDESIM_CHECK(
+        run_epidemic(sequential, graph, 0.05, true, pulls) == reference
+    );
+}
+
+// Checks that a contact repeated in two layers gives two independent trials,
+// and that restricting a kernel to a layer only uses its edges
+void test_frontier_transmission_layers() {
+    constexpr std::uint32_t pairs = 20000;
+    std::vector<std::tuple<std::uint32_t, std::uint32_t, float>> edges;
+    for (std::uint32_t i = 0; i < pairs; ++i) {
+        edges.emplace_back(2 * i, 2 * i + 1, 1.f);
+    }
+    graph_type graph(2 * pairs);
+    graph.assign<household>(edges, true);
+    graph.assign<workplace>(edges, true);
+    const std::vector<std::uint8_t> states(2 * pairs, 0);
+    agent_frontier infectious(2 * pairs);
+    agent_frontier infected(2 * pairs);
+    for (std::uint32_t i = 0; i < pairs; ++i) {
+        infectious.insert(2 * i);
+    }
+    const counter_based_rng<> rng(3);
+    transmission_type both(graph, 0.5);
+    both.step(states, 0, infectious, rng, infected);
+    const double fraction = double(infected.size()) / pairs;
+    EPIDESIM_CHECK(std::abs(fraction - 0.75) < 0.015);
+    transmission_type pulling(graph, 0.5, transmission_type::all_layers, -1);
+    agent_frontier pulled(2 * pairs);
+    pulling.step(states, 0, infectious, rng, pulled);
+    EPIDESIM_CHECK(pulled.indices() == infected.indices());
+    transmission_type single(graph, 0.5, graph_type::layer_index<workplace>());
+    infected.clear();
+    single.step(states, 0, infectious, rng, infected);
+    const double restricted = double(infected.size()) / pairs;
+    EPIDESIM_CHECK(std::abs(restricted - 0.5) < 0.015);
+    EPIDESIM_CHECK(single.layer() == 1 && single.probability() == 0.5);
+    const std::vector<std::uint8_t> immune(2 * pairs, 2);
+    EPIDESIM_CHECK(both.step(immune, 0, infectious, rng, infected) == 0);
+    const std::size_t kept = infected.size();
+    EPIDESIM_CHECK(both.step(states, 0, infectious, rng, infected) > 0);
+    EPIDESIM_CHECK(infected.size() > kept);
+    EPIDESIM_CHECK(infected.indices() == pulled.indices());
+}
+
+// Checks that directed layers are pushed along their edges even when the
+// kernel pulls, while symmetric layers are pulled
+void test_frontier_transmission_directed() {
+    graph_type pair(2);
+    pair.assign<household>(
+        std::vector<std::tuple<std::uint32_t, std::uint32_t, float>>{
+            {0, 1, 1.f}
+        }
+    );
+    const std::vector<std::uint8_t> states = {1, 0};
+    agent_frontier infectious(2);
+    infectious.insert(0);
+    const counter_based_rng<> rng(13);
+    transmission_type pushing(pair, 1.);
+    transmission_type pulling(pair, 1., transmission_type::all_layers, -1);
+    EPIDESIM_CHECK(!pulling.pulling(infectious));
+    agent_frontier pushed(2);
+    agent_frontier pulled(2);
+    EPIDESIM_CHECK(pushing.step(states, 0, infectious, rng, pushed) == 1);
+    EPIDESIM_CHECK(pulling.step(states, 0, infectious, rng, pulled) == 1);
+    EPIDESIM_CHECK(pushed.contains(1) && pulled.contains(1));
+    infection_proposals proposals;
+    infection_proposals::container_type infections;
+    EPIDESIM_CHECK(pulling.step(
+        states, 0, infectious, rng, proposals, infections
+    ) == 1);
+    EPIDESIM_CHECK(infections[0].target == 1 && infections[0].source == 0);
+    EPIDESIM_CHECK(pulling.pulls() == 0 && pulling.pushes() == 2);
+    constexpr std::uint32_t vertices = 20000;
+    std::mt19937 engine(6);
+    std::vector<std::tuple<std::uint32_t, std::uint32_t, float>> households;
+    std::vector<std::tuple<std::uint32_t, std::uint32_t, float>> workplaces;
+    for (std::uint32_t i = 0; i < vertices; ++i) {
+        households.emplace_back(i, i ^ 1, 1.f);
+        workplaces.emplace_back(i, engine() % vertices, 1.f);
+        workplaces.emplace_back(i, engine() % vertices, 1.f);
+    }
+    graph_type mixed(vertices);
+    mixed.assign<household>(households, true);
+    mixed.assign<workplace>(workplaces);
+    std::vector<std::uint8_t> susceptible(vertices, 0);
+    agent_frontier sources(vertices);
+    for (std::uint32_t i = 0; i < vertices; i += 7) {
+        susceptible[i] = 1;
+        sources.insert(i);
+    }
+    thread_pool pool(4);
+    transmission_type push(mixed, 0.5);
+    transmission_type pull(mixed, 0.5, transmission_type::all_layers, -1);
+    agent_frontier expected(vertices);
+    agent_frontier mixing(vertices);
+    push.step(pool, susceptible, 0, sources, rng, expected);
+    pull.step(pool, susceptible, 0, sources, rng, mixing);
+    EPIDESIM_CHECK(!expected.empty());
+    EPIDESIM_CHECK(mixing.indices() == expected.indices());
+    EPIDESIM_CHECK(pull.pulls() == 1 && pull.pushes() == 1);
+    infection_proposals::container_type pushed_infections;
+    push.step(pool, susceptible, 0, sources, rng, proposals, pushed_infections);
+    pull.step(pool, susceptible, 0, sources, rng, proposals, infections);
+    bool equal = infections.size() == pushed_infections.size();
+    for (std::size_t i = 0; equal && i < infections.size(); ++i) {
+        equal = infections[i].target == pushed_infections[i].target
+        && infections[i].source == pushed_infections[i].source
+        && infections[i].time == pushed_infections[i].time;
+    }
+    EPIDESIM_CHECK(equal && infections.size() == expected.size());
+}
+// ========================================================================== //
+
+
+
+// ========================== LOCATION TRANSMISSION ========================= //
+// Checks the probability of infection within well-mixed locations
+void test_location_transmission() {
+    constexpr std::uint32_t locations = 20000;
+    std::vector<std::uint32_t> column(3 * locations);
+    std::vector<std::uint8_t> states(3 * locations, 0);
+    std::vector<float> infectiousness(3 * locations, 0.f);
+    for (std::uint32_t i = 0; i < 3 * locations; ++i) {
+        column[i] = i / 3;
+        states[i] = i % 3 == 0;
+        infectiousness[i] = i % 3 == 0 ? 1.f : 0.f;
+    }
+    location_buckets buckets;
+    buckets.assign(column, locations);
+    const counter_based_rng<> rng(5, 0, 7);
+    const location_transmission<> frequency(0.5);
+    agent_frontier infected(3 * locations);
+    const std::size_t count = frequency.step(
+        buckets, infectiousness, states, 0, rng, infected
+    );
+    EPIDESIM_CHECK(count == infected.size());
+    const double expected = -std::expm1(-0.25);
+    const double fraction = double(count) / (2 * locations);
+    EPIDESIM_CHECK(std::abs(fraction - expected) < 0.015);
+    bool valid = true;
+    for (const std::uint32_t agent: infected) {
+        valid = valid && states[agent] == 0;
+    }
+    EPIDESIM_CHECK(valid);
+    thread_pool pool(4);
+    agent_frontier parallel(3 * locations);
+    const auto callable = [&infectiousness](std::uint32_t agent) {
+        return infectiousness[agent];
+    };
+    frequency.step(pool, buckets, callable, states, 0, rng, parallel);
+    EPIDESIM_CHECK(parallel.indices() == infected.indices());
+    const location_transmission<> density(0.5, false);
+    agent_frontier dense(3 * locations);
+    density.step(pool, buckets, infectiousness, states, 0, rng, dense);
+    const double denser = double(dense.size()) / (2 * locations);
+    EPIDESIM_CHECK(std::abs(denser + std::expm1(-0.5)) < 0.015);
+    EPIDESIM_CHECK(!density.frequency_dependent() && density.rate() == 0.5);
+}
+
+// Checks that pairwise and location layers accumulate their infections in
+// the same frontier, in any order
+void test_mixed_transmission() {
+    constexpr std::size_t vertices = 20000;
+    const graph_type graph = make_graph(vertices);
+    std::vector<std::uint32_t> column(vertices);
+    std::vector<std::uint8_t> states(vertices, 0);
+    agent_frontier infectious(vertices);
+    for (std::uint32_t i = 0; i < vertices; ++i) {
+        column[i] = i % 500;
+        if (i % 13 == 0) {
+            states[i] = 1;
+            infectious.insert(i);
+        }
+    }
+    const auto infectiousness = [&states](std::uint32_t agent) {
+        return states[agent] == 1 ? 1. : 0.;
+    };
+    location_buckets buckets;
+    buckets.assign(column, 500);
+    const counter_based_rng<> rng(9, 4, 0);
+    const counter_based_rng<> offices = rng.with(graph_type::layers);
+    transmission_type pairwise(
+        graph,
+        0.5,
+        graph_type::layer_index<household>()
+    );
+    const location_transmission<> location(2);
+    thread_pool pool(4);
+    agent_frontier first(vertices);
+    agent_frontier second(vertices);
+    const std::size_t households = pairwise.step(
+        pool, states, 0, infectious, rng, first
+    );
+    const std::size_t workplaces = location.step(
+        pool, buckets, infectiousness, states, 0, offices, second
+    );
+    EPIDESIM_CHECK(households > 0 && workplaces > 0);
+    std::vector<std::uint32_t> expected;
+    std::set_union(
+        first.begin(), first.end(),
+        second.begin(), second.end(),
+        std::back_inserter(expected)
+    );
+    EPIDESIM_CHECK(expected.size() < households + workplaces);
+    agent_frontier mixed(vertices);
+    const std::size_t total = pairwise.step(
+        pool, states, 0, infectious, rng, mixed
+    ) + location.step(
+        pool, buckets, infectiousness, states, 0, offices, mixed
+    );
+    EPIDESIM_CHECK(mixed.indices() == expected && total == expected.size());
+    agent_frontier reversed(vertices);
+    location.step(buckets, infectiousness, states, 0, offices, reversed);
+    pairwise.step(states, 0, infectious, rng, reversed);
+    EPIDESIM_CHECK(reversed.indices() == expected);
+}
+
+
+
+// ================================== MAIN ================================== //
+// Runs the tests
+int main() {
+    test_agent_frontier();
+    test_infection_proposals();
+    test_frontier_transmission();
+    test_frontier_transmission_layers();
+    test_frontier_transmission_directed();
+    test_location_transmission();
+    test_mixed_transmission();
+    return test_result();
+}
+// ========================================================================== //